@@ -0,0 +1,160 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Activity.hpp"
+#include "CompiledCircuit.hpp"
+#include "Simulator.hpp"
+
+#include <algorithm>
+
+ToggleCounter::ToggleCounter(const size_t nodes) {
+    toggles.assign(nodes, 0);
+    high.assign(nodes, 0);
+    previous.assign(nodes, 0);
+    pendingToggles.assign(nodes, 0);
+    pendingHigh.assign(nodes, 0);
+}
+
+void ToggleCounter::restart(const Uint8* state) {
+    std::copy_n(state, previous.size(), previous.begin());
+}
+
+void ToggleCounter::sample(const Uint8* state) {
+    const size_t n = previous.size();
+    Uint8* __restrict last = previous.data();
+    Uint8* __restrict toggled = pendingToggles.data();
+    Uint8* __restrict set = pendingHigh.data();
+    for (size_t i = 0; i < n; ++i) {
+        const Uint8 value = state[i];
+        toggled[i] += value ^ last[i];
+        set[i] += value;
+        last[i] = value;
+    }
+    samples++;
+    if (++pendingSamples == 255) flush();
+}
+
+void ToggleCounter::flush() {
+    for (size_t i = 0; i < toggles.size(); ++i) {
+        toggles[i] += pendingToggles[i];
+        high[i] += pendingHigh[i];
+    }
+    std::ranges::fill(pendingToggles, 0);
+    std::ranges::fill(pendingHigh, 0);
+    pendingSamples = 0;
+}
+
+void ToggleCounter::merge(ToggleCounter& other) {
+    flush();
+    other.flush();
+    for (size_t i = 0; i < toggles.size() && i < other.toggles.size(); ++i) {
+        toggles[i] += other.toggles[i];
+        high[i] += other.high[i];
+    }
+    samples += other.samples;
+}
+
+ActivityRecorder::ActivityRecorder() {
+    changedSlots = &changes;
+}
+
+void ActivityRecorder::onChange(const Object* obj) {
+    changes.push_back(obj->handle.slot);
+}
+
+void ActivityRecorder::onTimeAdvance() {
+    if (version != netlistVersion || simTime <= currentTime) restart();
+    // The changes were made in the delta cycle that just ended
+    else fold(simTime - 1);
+    currentTime = simTime;
+}
+
+void ActivityRecorder::restart() {
+    const size_t slots = simulationData.state.size();
+    changes.clear();
+    toggles.assign(slots, 0);
+    high.assign(slots, 0);
+    highSince.assign(slots, simTime);
+    level = simulationData.state;
+    startTime = currentTime = simTime;
+    version = netlistVersion;
+}
+
+// Counts the buffered changes, made at the given time, in order, so a glitch within one delta cycle
+// is two toggles
+void ActivityRecorder::fold(const Uint64 time) {
+    for (const Uint32 slot : changes) {
+        if (slot >= level.size()) continue;
+        toggles[slot]++;
+        level[slot] ^= 1;
+        if (level[slot]) highSince[slot] = time;
+        else high[slot] += time - highSince[slot];
+    }
+    changes.clear();
+}
+
+ToggleCounter ActivityRecorder::counts(const CompiledCircuit& circuit) {
+    if (version != netlistVersion) restart();
+    fold(simTime);
+
+    const auto& nodes = circuit.netlist.nodes;
+    ToggleCounter counter(nodes.size());
+    for (Uint32 i = 0; i < nodes.size(); ++i) {
+        const Uint32 slot = nodes[i]->handle.slot;
+        if (slot >= level.size()) continue;
+        counter.toggles[i] = toggles[slot];
+        counter.high[i] = high[slot] + (level[slot] ? simTime - highSince[slot] : 0);
+    }
+    counter.samples = simTime - startTime;
+    return counter;
+}
+
+float PowerModel::capacitance(const CompiledCircuit& circuit, const Uint32 node) const {
+    switch (circuit.kind[node]) {
+        case CompiledCircuit::GATE: return gateCapacitance[circuit.param[node] & 7];
+        case CompiledCircuit::WIRE: return wireCapacitance;
+        case CompiledCircuit::FLIPFLOP: return flipFlopCapacitance;
+        case CompiledCircuit::RAM:
+        case CompiledCircuit::ROM: return memoryCapacitance;
+        case CompiledCircuit::BUTTON:
+        case CompiledCircuit::CLOCK:
+        case CompiledCircuit::LED: return ioCapacitance;
+        default: return 0.0f;
+    }
+}
+
+bool writeSaif(const char* path, const CompiledCircuit& circuit, const ToggleCounter& counter) {
+    SDL_IOStream* file = SDL_IOFromFile(path, "w");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    const auto duration = static_cast<unsigned long long>(counter.samples);
+    SDL_IOprintf(file, "(SAIFILE\n(SAIFVERSION \"2.0\")\n(DIRECTION \"backward\")\n(DESIGN \"logicsim\")\n");
+    SDL_IOprintf(file, "(PROGRAM_NAME \"LogicSim\")\n(DIVIDER / )\n(TIMESCALE 1 ns)\n(DURATION %llu)\n", duration);
+    SDL_IOprintf(file, "(INSTANCE top\n  (NET\n");
+    for (Uint32 i = 0; i < counter.toggles.size(); ++i) {
+        if (circuit.kind[i] == CompiledCircuit::OTHER) continue;
+        const auto high = static_cast<unsigned long long>(counter.high[i]);
+        SDL_IOprintf(file, "    (%s (T0 %llu) (T1 %llu) (TC %llu))\n", objectName(circuit.netlist.nodes[i]).c_str(),
+            duration - high, high, static_cast<unsigned long long>(counter.toggles[i]));
+    }
+    SDL_IOprintf(file, "  )\n)\n)\n");
+    SDL_CloseIO(file);
+    return true;
+}
+
+double estimatePower(const CompiledCircuit& circuit, const ToggleCounter& counter, const PowerModel& model) {
+    if (counter.samples == 0) return 0.0;
+
+    // Switched capacitance per edge, then two edges per clock period
+    double switched = 0.0;
+    for (Uint32 i = 0; i < counter.toggles.size(); ++i) {
+        switched += static_cast<double>(counter.toggles[i]) * model.capacitance(circuit, i) * 1e-15;
+    }
+    const double perEdge = switched / static_cast<double>(counter.samples);
+    return 0.5 * perEdge * model.voltage * model.voltage * 2.0 * model.frequency;
+}
@@ -0,0 +1,95 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef ACTIVITY_HPP
+#define ACTIVITY_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "Simulator.hpp"
+
+class CompiledCircuit;
+
+// Switching activity of every node of a circuit. Samples are accumulated into 8-bit counters by a
+// loop the compiler vectorizes, and folded into the 64-bit totals every 255 samples, so counting
+// costs a few byte operations per node and sample.
+class ToggleCounter {
+public:
+    // Totals as of the last flush()
+    std::vector<Uint64> toggles;
+    std::vector<Uint64> high; // Samples the node spent at 1
+    Uint64 samples = 0;
+
+    explicit ToggleCounter(size_t nodes = 0);
+
+    // Starts counting from the given states, without counting them as toggles
+    void restart(const Uint8* state);
+    void sample(const Uint8* state);
+    // Folds the pending 8-bit counts into the totals
+    void flush();
+    void merge(ToggleCounter& other);
+
+private:
+    std::vector<Uint8> previous;
+    std::vector<Uint8> pendingToggles;
+    std::vector<Uint8> pendingHigh;
+    Uint32 pendingSamples = 0;
+};
+
+// Toggle counting for the live engines, propagate() and CycleSimulator. Both report every change of
+// state through changedSlots, so between two delta cycles the recorder only touches the objects
+// that changed. Counts are kept per handle slot and start over whenever the circuit is edited or
+// the time goes back, e.g. on a checkpoint restore or a step back through the journal.
+class ActivityRecorder final : public ChangeListener {
+public:
+    ActivityRecorder();
+
+    void onChange(const Object* obj) override;
+    void onTimeAdvance() override;
+
+    // Starts counting from the current states and simTime
+    void restart();
+    /**
+     * @brief Totals per node of a circuit compiled from the current objects, one sample per time unit:
+     * an edge of the fastest clock in cycle mode, a delta cycle in event-driven mode.
+     */
+    ToggleCounter counts(const CompiledCircuit& circuit);
+
+private:
+    std::vector<Uint32> changes; // Handle slots of the objects that changed since the last fold
+    std::vector<Uint64> toggles; // Per handle slot
+    std::vector<Uint64> high; // Time spent at 1 before highSince
+    std::vector<Uint64> highSince;
+    std::vector<Uint8> level;
+    Uint64 startTime = 0;
+    Uint64 currentTime = 0;
+    Uint64 version = 0; // netlistVersion the counts belong to
+
+    void fold(Uint64 time);
+};
+
+// Switched capacitance per object, in femtofarads, for a dynamic power estimate of P = a * C * V^2 * f / 2
+struct PowerModel {
+    float gateCapacitance[8] = {1.0f, 0.8f, 1.5f, 1.5f, 1.2f, 1.3f, 2.2f, 2.2f}; // Indexed by GateType
+    float wireCapacitance = 0.5f;
+    float flipFlopCapacitance = 3.0f;
+    float memoryCapacitance = 8.0f;
+    float ioCapacitance = 2.0f; // Buttons, clocks and leds
+    float voltage = 1.0f;
+    float frequency = 100e6f; // Of the fastest clock, in Hz
+
+    float capacitance(const CompiledCircuit& circuit, Uint32 node) const;
+};
+
+/**
+ * @brief Writes the activity in the SAIF format, with one net per object and one time unit per clock edge.
+ * @return false if the file couldn't be created.
+ */
+bool writeSaif(const char* path, const CompiledCircuit& circuit, const ToggleCounter& counter);
+
+// Dynamic power in watts. Toggles are counted per edge, so there are two samples per clock period.
+double estimatePower(const CompiledCircuit& circuit, const ToggleCounter& counter, const PowerModel& model);
+
+#endif //ACTIVITY_HPP
@@ -0,0 +1,184 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+// Build step that decodes the component PNGs once and packs them into a single RGBA atlas, so the
+// application uploads one ready-made texture at startup instead of decoding images.
+//
+// Usage: AtlasBuilder <atlas.rgba> <AtlasIndex.hpp> <downscale> <image.png>...
+// The images must be given in the order of the Asset enum. The atlas holds them shrunk by the
+// downscale factor, small enough that the components, drawn at 0.05 of their size, are never
+// magnified up to the maximum zoom, while the index keeps their original size for object sizes
+// and pin positions. A small white block is packed alongside, so solid rectangles can be drawn
+// from the same texture.
+
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct Image {
+    std::string name;
+    int width = 0, height = 0; // Of the original PNG
+    int w = 0, h = 0; // In the atlas
+    int x = 0, y = 0;
+    std::vector<Uint8> pixels; // w * h RGBA, straight alpha
+};
+
+static constexpr int PADDING = 2; // Transparent border, so linear filtering doesn't bleed neighbours in
+static constexpr int WHITE_SIZE = 4; // Only the inner texels are sampled, the edges blend into the padding
+
+// Box filter that weights colours by alpha, so transparent pixels don't darken the edges
+static bool loadImage(const char* path, const int downscale, Image& image) {
+    SDL_Surface* loaded = IMG_Load(path);
+    if (!loaded) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load %s: %s", path, SDL_GetError());
+        return false;
+    }
+    SDL_Surface* rgba = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(loaded);
+    if (!rgba) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to convert %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    const std::string file = path;
+    image.name = file.substr(file.find_last_of("/\\") + 1);
+    image.width = rgba->w;
+    image.height = rgba->h;
+    image.w = (rgba->w + downscale - 1) / downscale;
+    image.h = (rgba->h + downscale - 1) / downscale;
+    image.pixels.assign(static_cast<size_t>(image.w) * image.h * 4, 0);
+
+    const auto* source = static_cast<const Uint8*>(rgba->pixels);
+    for (int y = 0; y < image.h; ++y) {
+        for (int x = 0; x < image.w; ++x) {
+            Uint64 r = 0, g = 0, b = 0, a = 0, count = 0;
+            for (int sy = y * downscale; sy < std::min((y + 1) * downscale, rgba->h); ++sy) {
+                const Uint8* row = source + static_cast<size_t>(sy) * rgba->pitch;
+                for (int sx = x * downscale; sx < std::min((x + 1) * downscale, rgba->w); ++sx) {
+                    const Uint8* p = row + sx * 4;
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
+                    count++;
+                }
+            }
+            Uint8* out = &image.pixels[(static_cast<size_t>(y) * image.w + x) * 4];
+            if (a > 0) {
+                out[0] = static_cast<Uint8>(r / a);
+                out[1] = static_cast<Uint8>(g / a);
+                out[2] = static_cast<Uint8>(b / a);
+            }
+            out[3] = static_cast<Uint8>(a / count);
+        }
+    }
+    SDL_DestroySurface(rgba);
+    return true;
+}
+
+// Shelf packing, tallest images first, into the narrowest power-of-two width that keeps the atlas
+// roughly square
+static void pack(std::vector<Image>& images, int& width, int& height) {
+    size_t area = 0;
+    int widest = 0;
+    for (const auto& image : images) {
+        area += static_cast<size_t>(image.w + PADDING) * (image.h + PADDING);
+        widest = std::max(widest, image.w + PADDING);
+    }
+    width = 64;
+    while (width < widest || static_cast<size_t>(width) * width < area) width *= 2;
+
+    std::vector<Image*> byHeight;
+    for (auto& image : images) byHeight.push_back(&image);
+    std::ranges::stable_sort(byHeight, std::greater{}, &Image::h);
+
+    int x = 0, y = 0, shelf = 0;
+    for (auto* image : byHeight) {
+        if (x + image->w + PADDING > width) {
+            x = 0;
+            y += shelf;
+            shelf = 0;
+        }
+        image->x = x + PADDING / 2;
+        image->y = y + PADDING / 2;
+        x += image->w + PADDING;
+        shelf = std::max(shelf, image->h + PADDING);
+    }
+    height = y + shelf;
+}
+
+static bool writeAtlas(const char* path, const std::vector<Image>& images, const int width, const int height) {
+    std::vector<Uint8> atlas(static_cast<size_t>(width) * height * 4, 0);
+    for (const auto& image : images) {
+        for (int y = 0; y < image.h; ++y) {
+            std::copy_n(&image.pixels[static_cast<size_t>(y) * image.w * 4], image.w * 4,
+                        &atlas[(static_cast<size_t>(image.y + y) * width + image.x) * 4]);
+        }
+    }
+
+    SDL_IOStream* file = SDL_IOFromFile(path, "wb");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create %s: %s", path, SDL_GetError());
+        return false;
+    }
+    const bool ok = SDL_WriteIO(file, atlas.data(), atlas.size()) == atlas.size();
+    SDL_CloseIO(file);
+    return ok;
+}
+
+static bool writeIndex(const char* path, const std::vector<Image>& images, const int width, const int height,
+                       const int downscale) {
+    SDL_IOStream* file = SDL_IOFromFile(path, "w");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create %s: %s", path, SDL_GetError());
+        return false;
+    }
+    SDL_IOprintf(file, "// Generated by AtlasBuilder from Assets/*.png. Do not edit.\n\n");
+    SDL_IOprintf(file, "#ifndef ATLASINDEX_HPP\n#define ATLASINDEX_HPP\n\n");
+    SDL_IOprintf(file, "// Size of atlas.rgba in pixels, 4 bytes each\n");
+    SDL_IOprintf(file, "constexpr int ATLAS_WIDTH = %d;\nconstexpr int ATLAS_HEIGHT = %d;\n", width, height);
+    SDL_IOprintf(file, "// Source pixels per atlas texel\nconstexpr int ATLAS_DOWNSCALE = %d;\n\n", downscale);
+    SDL_IOprintf(file, "struct AtlasEntry {\n    float x, y, w, h; // In the atlas\n");
+    SDL_IOprintf(file, "    float width, height; // Of the original image\n};\n\n");
+    SDL_IOprintf(file, "constexpr AtlasEntry ATLAS_ENTRIES[] = {\n");
+    for (size_t i = 0; i + 1 < images.size(); ++i) {
+        const auto& image = images[i];
+        SDL_IOprintf(file, "    {%d, %d, %d, %d, %d, %d}, // %s\n", image.x, image.y, image.w, image.h,
+            image.width, image.height, image.name.c_str());
+    }
+    const auto& white = images.back();
+    SDL_IOprintf(file, "};\n\n// Opaque white texels, for solid rectangles\n");
+    SDL_IOprintf(file, "constexpr AtlasEntry ATLAS_WHITE = {%d, %d, %d, %d, %d, %d};\n", white.x + 1, white.y + 1,
+        white.w - 2, white.h - 2, white.w - 2, white.h - 2);
+    SDL_IOprintf(file, "\n#endif //ATLASINDEX_HPP\n");
+    SDL_CloseIO(file);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 5) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Usage: %s <atlas.rgba> <AtlasIndex.hpp> <downscale> <image.png>...", argv[0]);
+        return 1;
+    }
+    const int downscale = std::max(1, SDL_atoi(argv[3]));
+
+    std::vector<Image> images(argc - 4);
+    for (int i = 4; i < argc; ++i) {
+        if (!loadImage(argv[i], downscale, images[i - 4])) return 1;
+    }
+    auto& white = images.emplace_back();
+    white.name = "white";
+    white.w = white.h = white.width = white.height = WHITE_SIZE;
+    white.pixels.assign(WHITE_SIZE * WHITE_SIZE * 4, 255);
+
+    int width, height;
+    pack(images, width, height);
+    if (!writeAtlas(argv[1], images, width, height) || !writeIndex(argv[2], images, width, height, downscale)) return 1;
+
+    SDL_Log("Packed %zu images into a %dx%d atlas.", images.size() - 1, width, height);
+    return 0;
+}
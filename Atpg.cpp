@@ -0,0 +1,390 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Atpg.hpp"
+#include "FaultSimulator.hpp"
+#include "Stimulus.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+
+// Three-valued logic for PODEM
+static constexpr Uint8 X = 2;
+
+static Uint8 or3(const Uint8 a, const Uint8 b) {
+    if (a == 1 || b == 1) return 1;
+    return a == X || b == X ? X : 0;
+}
+
+static Uint8 and3(const Uint8 a, const Uint8 b) {
+    if (a == 0 || b == 0) return 0;
+    return a == X || b == X ? X : 1;
+}
+
+static Uint8 not3(const Uint8 a) {
+    return a == X ? X : a ^ 1;
+}
+
+static Uint8 eval3(const GateType type, const Uint8 a, const Uint8 b) {
+    switch (type) {
+        case BUF: return a;
+        case NOT: return not3(a);
+        case AND: return and3(a, b);
+        case OR: return or3(a, b);
+        case NAND: return not3(and3(a, b));
+        case NOR: return not3(or3(a, b));
+        case XOR: return a == X || b == X ? X : a ^ b;
+        case XNOR: return a == X || b == X ? X : a ^ b ^ 1;
+    }
+    return X;
+}
+
+static bool inverting(const GateType type) {
+    return type == NOT || type == NAND || type == NOR || type == XNOR;
+}
+
+// PODEM on a single fault. Decisions are only ever made on the model inputs; after each one the
+// fault-free and the faulty machine are re-simulated in three-valued logic.
+class Podem {
+public:
+    Podem(const CombinationalModel& model, const int backtrackLimit) : model(model), backtrackLimit(backtrackLimit) {
+        inputOf.assign(model.signalCount, -1);
+        for (size_t i = 0; i < model.inputs.size(); ++i) inputOf[model.inputs[i]] = static_cast<Sint32>(i);
+        good.resize(model.signalCount);
+        faulty.resize(model.signalCount);
+        pinGood.resize(model.pinSourceStart.size());
+        pinFaulty.resize(model.pinSourceStart.size());
+
+        // Signals with a structural path to an output. Faults anywhere else are redundant.
+        observable.assign(model.signalCount, false);
+        for (const Uint32 pin : model.outputs) {
+            for (Uint32 s = model.pinSourceStart[pin]; s < model.pinSourceStart[pin + 1]; ++s) {
+                observable[model.pinSources[s]] = true;
+            }
+        }
+        observedStart.assign(model.signalCount + 1, 0);
+        for (const Uint32 pin : model.outputs) {
+            for (Uint32 s = model.pinSourceStart[pin]; s < model.pinSourceStart[pin + 1]; ++s) {
+                observedStart[model.pinSources[s] + 1]++;
+            }
+        }
+        for (size_t s = 0; s < model.signalCount; ++s) observedStart[s + 1] += observedStart[s];
+        observed.resize(observedStart[model.signalCount]);
+        std::vector<Uint32> fill(observedStart.begin(), observedStart.end() - 1);
+        for (const Uint32 pin : model.outputs) {
+            for (Uint32 s = model.pinSourceStart[pin]; s < model.pinSourceStart[pin + 1]; ++s) {
+                observed[fill[model.pinSources[s]]++] = pin;
+            }
+        }
+        visited.assign(model.signalCount, 0);
+
+        for (auto cell = model.cells.rbegin(); cell != model.cells.rend(); ++cell) {
+            if (!observable[cell->signal]) continue;
+            for (Uint32 p = cell->pinStart; p < cell->pinStart + cell->pins; ++p) {
+                for (Uint32 s = model.pinSourceStart[p]; s < model.pinSourceStart[p + 1]; ++s) {
+                    observable[model.pinSources[s]] = true;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Searches for a pattern detecting the fault.
+     * @param cube Receives the input assignment, with X for inputs the test doesn't care about.
+     */
+    Atpg::Result generate(const Fault& target, std::vector<Uint8>& cube) {
+        fault = target;
+        cube.assign(model.inputs.size(), X);
+        if (!observable[model.cells[fault.cell].signal]) return Atpg::REDUNDANT;
+        std::vector<std::pair<Uint32, bool>> decisions; // Input, and whether its other value was tried
+        int backtracks = 0;
+
+        while (true) {
+            imply(cube);
+            if (isDetected()) return Atpg::DETECTED;
+
+            Uint32 input;
+            Uint8 value;
+            if (objective(input, value)) {
+                cube[input] = value;
+                decisions.emplace_back(input, false);
+                continue;
+            }
+
+            while (!decisions.empty() && decisions.back().second) {
+                cube[decisions.back().first] = X;
+                decisions.pop_back();
+            }
+            if (decisions.empty()) return Atpg::REDUNDANT;
+            if (++backtracks > backtrackLimit) return Atpg::ABORTED;
+            cube[decisions.back().first] ^= 1;
+            decisions.back().second = true;
+        }
+    }
+
+private:
+    const CombinationalModel& model;
+    int backtrackLimit;
+    Fault fault{};
+    std::vector<Sint32> inputOf; // Per signal
+    std::vector<Uint8> good, faulty; // Per signal
+    std::vector<Uint8> pinGood, pinFaulty; // Per model pin
+    std::vector<bool> observable; // Per signal
+    // Output pins read by signal s are observed[observedStart[s]] .. observed[observedStart[s + 1] - 1]
+    std::vector<Uint32> observedStart, observed;
+    std::vector<Uint32> visited, stack; // For xPath
+    Uint32 epoch = 0;
+
+    bool isD(const Uint32 signal) const {
+        return good[signal] != X && faulty[signal] != X && good[signal] != faulty[signal];
+    }
+
+    bool isX(const Uint32 signal) const {
+        return good[signal] == X || faulty[signal] == X;
+    }
+
+    void evalPin(const Uint32 pin) {
+        Uint8 g = 0, f = 0;
+        for (Uint32 s = model.pinSourceStart[pin]; s < model.pinSourceStart[pin + 1]; ++s) {
+            g = or3(g, good[model.pinSources[s]]);
+            f = or3(f, faulty[model.pinSources[s]]);
+        }
+        pinGood[pin] = g;
+        pinFaulty[pin] = f;
+    }
+
+    void imply(const std::vector<Uint8>& cube) {
+        std::ranges::fill(good, 0);
+        std::ranges::fill(faulty, 0);
+        for (size_t i = 0; i < cube.size(); ++i) good[model.inputs[i]] = faulty[model.inputs[i]] = cube[i];
+
+        for (Uint32 c = 0; c < model.cells.size(); ++c) {
+            const auto& cell = model.cells[c];
+            for (Uint32 k = 0; k < cell.pins; ++k) {
+                evalPin(cell.pinStart + k);
+                if (fault.cell == c && fault.pin == static_cast<Sint32>(k)) pinFaulty[cell.pinStart + k] = fault.stuckAt;
+            }
+            const Uint32 a = cell.pinStart, b = cell.pinStart + (cell.pins > 1 ? 1 : 0);
+            const Uint8 gb = cell.pins > 1 ? pinGood[b] : 0, fb = cell.pins > 1 ? pinFaulty[b] : 0;
+            good[cell.signal] = cell.pins > 0 ? eval3(cell.type, pinGood[a], gb) : eval3(cell.type, 0, 0);
+            faulty[cell.signal] = cell.pins > 0 ? eval3(cell.type, pinFaulty[a], fb) : eval3(cell.type, 0, 0);
+            if (fault.cell == c && fault.pin < 0) faulty[cell.signal] = fault.stuckAt;
+        }
+        for (const Uint32 pin : model.outputs) evalPin(pin);
+    }
+
+    bool isDetected() const {
+        return std::ranges::any_of(model.outputs, [this](const Uint32 pin) {
+            return pinGood[pin] != X && pinFaulty[pin] != X && pinGood[pin] != pinFaulty[pin];
+        });
+    }
+
+    // Walks an objective back to an unassigned input, through signals that are still X
+    bool backtrace(Uint32 signal, Uint8 value, Uint32& input, Uint8& inputValue) const {
+        while (inputOf[signal] < 0) {
+            const Sint32 c = model.driver[signal];
+            if (c < 0) return false;
+            const auto& cell = model.cells[c];
+            if (inverting(cell.type)) value ^= 1;
+            if (!pickSource(cell, signal)) return false;
+        }
+        input = static_cast<Uint32>(inputOf[signal]);
+        inputValue = value;
+        return true;
+    }
+
+    // First X source on any input pin of the cell
+    bool pickSource(const CombinationalModel::Cell& cell, Uint32& signal) const {
+        for (Uint32 p = cell.pinStart; p < cell.pinStart + cell.pins; ++p) {
+            if (pickSource(p, signal)) return true;
+        }
+        return false;
+    }
+
+    bool pickSource(const Uint32 pin, Uint32& signal) const {
+        for (Uint32 s = model.pinSourceStart[pin]; s < model.pinSourceStart[pin + 1]; ++s) {
+            if (isX(model.pinSources[s])) {
+                signal = model.pinSources[s];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Some source carries the fault effect, but an X source keeps the wired OR from passing it on
+    bool blockedPin(const Uint32 pin, Uint32& signal) const {
+        if (pinGood[pin] != X && pinFaulty[pin] != X) return false;
+        bool hasD = false;
+        for (Uint32 s = model.pinSourceStart[pin]; s < model.pinSourceStart[pin + 1]; ++s) {
+            hasD |= isD(model.pinSources[s]);
+        }
+        return hasD && pickSource(pin, signal);
+    }
+
+    // Whether the signal can still reach an output through signals that are X
+    bool xPath(const Uint32 from) {
+        ++epoch;
+        visited[from] = epoch;
+        stack.assign(1, from);
+        while (!stack.empty()) {
+            const Uint32 s = stack.back();
+            stack.pop_back();
+            for (Uint32 o = observedStart[s]; o < observedStart[s + 1]; ++o) {
+                const Uint32 pin = observed[o];
+                if (pinGood[pin] == X || pinFaulty[pin] == X) return true;
+            }
+            for (Uint32 e = model.fanoutStart[s]; e < model.fanoutStart[s + 1]; ++e) {
+                const Uint32 next = model.cells[model.fanout[e]].signal;
+                if (isX(next) && visited[next] != epoch) {
+                    visited[next] = epoch;
+                    stack.push_back(next);
+                }
+            }
+        }
+        return false;
+    }
+
+    bool objective(Uint32& input, Uint8& value) {
+        // Activate the fault
+        const auto& site = model.cells[fault.cell];
+        const Uint32 sitePin = site.pinStart + (fault.pin < 0 ? 0 : fault.pin);
+        const Uint8 siteValue = fault.pin < 0 ? good[site.signal] : pinGood[sitePin];
+        if (siteValue == X) {
+            Uint32 signal = site.signal;
+            if (!xPath(site.signal)) return false;
+            if (fault.pin >= 0 && !pickSource(sitePin, signal)) return false;
+            return backtrace(signal, !fault.stuckAt, input, value);
+        }
+        if (siteValue == fault.stuckAt) return false;
+
+        // Propagate it through the D-frontier, towards the outputs first
+        Uint32 signal;
+        for (const Uint32 pin : model.outputs) {
+            if (blockedPin(pin, signal)) return backtrace(signal, 0, input, value);
+        }
+        for (const auto& cell : model.cells) {
+            if (!isX(cell.signal) || !observable[cell.signal]) continue;
+            bool hasD = false, blocked = false;
+            Uint32 blocker = 0;
+            for (Uint32 p = cell.pinStart; p < cell.pinStart + cell.pins; ++p) {
+                hasD |= pinGood[p] != X && pinFaulty[p] != X && pinGood[p] != pinFaulty[p];
+                if (!blocked) blocked = blockedPin(p, blocker);
+            }
+            if (!(hasD || blocked) || !xPath(cell.signal)) continue;
+            if (blocked) return backtrace(blocker, 0, input, value);
+
+            // Set the other input to the non-controlling value
+            const Uint8 nonControlling = cell.type == AND || cell.type == NAND ? 1 : 0;
+            for (Uint32 p = cell.pinStart; p < cell.pinStart + cell.pins; ++p) {
+                if ((pinGood[p] == X || pinFaulty[p] == X) && pickSource(p, signal)) {
+                    return backtrace(signal, nonControlling, input, value);
+                }
+            }
+        }
+        return false;
+    }
+};
+
+Atpg::Atpg(const CombinationalModel& model, const unsigned threads, const int backtrackLimit)
+    : model(model), threads(threads), backtrackLimit(backtrackLimit) {
+    if (this->threads == 0) this->threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Atpg::run() {
+    patterns.clear();
+    redundant = aborted = 0;
+
+    FaultSimulator simulator(model);
+    faults = simulator.faults.size();
+    std::mt19937_64 rng(1);
+    const auto fill = [&rng](const std::vector<Uint8>& cube, Pattern& pattern) {
+        pattern.resize(cube.size());
+        for (size_t i = 0; i < cube.size(); ++i) pattern[i] = cube[i] == X ? (rng() & 1) : cube[i];
+    };
+
+    // Random patterns while they keep paying off
+    constexpr size_t PATIENCE = 64;
+    std::vector<Uint8> cube(model.inputs.size(), X);
+    Pattern pattern;
+    for (size_t useless = 0; useless < PATIENCE && simulator.detectedCount() < faults;) {
+        fill(cube, pattern);
+        if (simulator.simulate(pattern) > 0) {
+            patterns.push_back(pattern);
+            useless = 0;
+        } else {
+            useless++;
+        }
+    }
+    const size_t randomPatterns = patterns.size();
+
+    // PODEM on whatever is left, a batch of faults at a time so that the faults detected by
+    // earlier patterns are dropped before anyone targets them
+    std::vector<Podem> engines(threads, Podem(model, backtrackLimit));
+    const size_t batchSize = threads * 16;
+    std::vector<Uint32> batch;
+    std::vector<Result> results;
+    std::vector<std::vector<Uint8>> cubes;
+    for (Uint32 next = 0; next < faults;) {
+        batch.clear();
+        for (; next < faults && batch.size() < batchSize; ++next) {
+            if (!simulator.detected[next]) batch.push_back(next);
+        }
+        results.assign(batch.size(), ABORTED);
+        cubes.resize(batch.size());
+
+        std::atomic<size_t> claimed = 0;
+        const auto work = [&](Podem& engine) {
+            for (size_t k; (k = claimed.fetch_add(1)) < batch.size();) {
+                results[k] = engine.generate(simulator.faults[batch[k]], cubes[k]);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads && t < batch.size(); ++t) workers.emplace_back(work, std::ref(engines[t]));
+        work(engines[0]);
+        for (auto& worker : workers) worker.join();
+
+        for (size_t k = 0; k < batch.size(); ++k) {
+            if (results[k] == REDUNDANT) redundant++;
+            else if (results[k] == ABORTED) aborted++;
+            else if (!simulator.detected[batch[k]]) {
+                fill(cubes[k], pattern);
+                if (simulator.simulate(pattern) > 0) patterns.push_back(pattern);
+            }
+        }
+    }
+    detected = simulator.detectedCount();
+
+    // Reverse-order compaction: the late, targeted patterns usually cover the random ones
+    const size_t generated = patterns.size();
+    simulator.reset();
+    std::vector<Pattern> compacted;
+    for (auto it = patterns.rbegin(); it != patterns.rend() && simulator.detectedCount() < detected; ++it) {
+        if (simulator.simulate(*it) > 0) compacted.push_back(std::move(*it));
+    }
+    std::ranges::reverse(compacted);
+    patterns = std::move(compacted);
+
+    SDL_Log("ATPG: %zu of %zu faults detected (%.2f%%), %zu redundant, %zu aborted.",
+        detected, faults, coverage(), redundant, aborted);
+    SDL_Log("ATPG: %zu patterns (%zu random, %zu deterministic) compacted to %zu.",
+        generated, randomPatterns, generated - randomPatterns, patterns.size());
+}
+
+double Atpg::coverage() const {
+    return faults == 0 ? 100.0 : 100.0 * static_cast<double>(detected) / static_cast<double>(faults);
+}
+
+bool Atpg::writeVectors(const char* path, const bool binary) const {
+    StimulusWriter writer;
+    if (!writer.open(path, model.inputNames, model.outputNames, binary)) return false;
+    for (const auto& pattern : patterns) {
+        writer.write(pattern, model.evaluate(pattern));
+    }
+    writer.close();
+    SDL_Log("Wrote %zu test vectors to %s.", patterns.size(), path);
+    return true;
+}
@@ -0,0 +1,41 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef ATPG_HPP
+#define ATPG_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "CombinationalModel.hpp"
+
+// Automatic test pattern generation for single stuck-at faults. Random patterns pick off the easy
+// faults first, then PODEM targets the remaining ones on all cores. Every generated pattern is fault
+// simulated so that the faults it detects by accident are dropped, and the final set is compacted
+// by simulating it again in reverse order and discarding patterns that detect nothing new.
+class Atpg {
+public:
+    enum Result { DETECTED, REDUNDANT, ABORTED };
+
+    std::vector<Pattern> patterns;
+    size_t faults = 0;
+    size_t detected = 0;
+    size_t redundant = 0; // Proven untestable
+    size_t aborted = 0; // Gave up after too many backtracks
+
+    explicit Atpg(const CombinationalModel& model, unsigned threads = 0, int backtrackLimit = 1000);
+
+    void run();
+    double coverage() const;
+
+    // Writes the patterns and their fault-free responses as a stimulus file, see Stimulus.hpp
+    bool writeVectors(const char* path, bool binary = false) const;
+
+private:
+    const CombinationalModel& model;
+    unsigned threads;
+    int backtrackLimit;
+};
+
+#endif //ATPG_HPP
@@ -0,0 +1,63 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Camera.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr float ZOOM_RATE = 15.0f; // How fast the zoom closes in on its target, per second
+
+SDL_FRect Camera::visibleArea(const int width, const int height) const {
+    return {x, y, static_cast<float>(width) / zoom, static_cast<float>(height) / zoom};
+}
+
+void Camera::pan(const float dx, const float dy) {
+    x -= dx / zoom;
+    y -= dy / zoom;
+    // Keep an ongoing zoom centred on the same spot of the screen
+    anchorWorld.x -= dx / zoom;
+    anchorWorld.y -= dy / zoom;
+}
+
+void Camera::zoomAt(const float sx, const float sy, const float factor) {
+    anchorScreen = {sx, sy};
+    anchorWorld = toWorld(sx, sy);
+    targetZoom = std::clamp(targetZoom * factor, MIN_ZOOM, MAX_ZOOM);
+}
+
+void Camera::update(const Uint64 nowMs) {
+    const float dt = lastUpdateMs == 0 ? 0.0f : static_cast<float>(nowMs - lastUpdateMs) / 1000.0f;
+    lastUpdateMs = nowMs;
+    if (zoom == targetZoom) return;
+
+    // Exponential easing in log space, so zooming in and out feel the same
+    const float t = 1.0f - std::exp(-ZOOM_RATE * dt);
+    zoom = std::exp(std::log(zoom) + (std::log(targetZoom) - std::log(zoom)) * t);
+    if (std::abs(zoom - targetZoom) < targetZoom * 0.001f) zoom = targetZoom;
+    x = anchorWorld.x - anchorScreen.x / zoom;
+    y = anchorWorld.y - anchorScreen.y / zoom;
+}
+
+bool Camera::handleEvent(const SDL_Event* event) {
+    switch (event->type) {
+    case SDL_EVENT_MOUSE_WHEEL: {
+        const float notches = event->wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event->wheel.y : event->wheel.y;
+        zoomAt(event->wheel.mouse_x, event->wheel.mouse_y, std::pow(ZOOM_STEP, notches));
+        return true;
+    }
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        if (event->button.button != SDL_BUTTON_MIDDLE) return false;
+        panning = event->type == SDL_EVENT_MOUSE_BUTTON_DOWN;
+        return true;
+    case SDL_EVENT_MOUSE_MOTION:
+        if (!panning) return false;
+        pan(event->motion.xrel, event->motion.yrel);
+        return true;
+    default:
+        return false;
+    }
+}
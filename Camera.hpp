@@ -0,0 +1,52 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include <SDL3/SDL.h>
+
+// Maps the canvas, where objects live, to the window. The middle mouse button pans, the wheel zooms
+// around the mouse. Zooming eases towards its target over a few frames, see update().
+class Camera {
+public:
+    static constexpr float MIN_ZOOM = 0.01f;
+    static constexpr float MAX_ZOOM = 8.0f;
+    static constexpr float ZOOM_STEP = 1.25f; // Per notch of the wheel
+    // Below this zoom components are drawn as flat rectangles, see lowDetail()
+    static constexpr float LOW_DETAIL_ZOOM = 0.4f;
+    // Below this zoom, where a cell of the spatial index is 8 pixels wide, only the occupied cells are
+    // drawn, see overview()
+    static constexpr float OVERVIEW_ZOOM = 0.0625f;
+
+    float x = 0.0f, y = 0.0f; // Canvas position at the top left corner of the window
+    float zoom = 1.0f; // Window pixels per canvas unit
+
+    SDL_FPoint toScreen(const float wx, const float wy) const { return {(wx - x) * zoom, (wy - y) * zoom}; }
+    SDL_FRect toScreen(const SDL_FRect& rect) const {
+        return {(rect.x - x) * zoom, (rect.y - y) * zoom, rect.w * zoom, rect.h * zoom};
+    }
+    SDL_FPoint toWorld(const float sx, const float sy) const { return {x + sx / zoom, y + sy / zoom}; }
+    // Part of the canvas shown in a window of the given size
+    SDL_FRect visibleArea(int width, int height) const;
+    bool lowDetail() const { return zoom < LOW_DETAIL_ZOOM; }
+    bool overview() const { return zoom < OVERVIEW_ZOOM; }
+
+    void pan(float dx, float dy);
+    void zoomAt(float sx, float sy, float factor);
+    // Eases the zoom towards its target, keeping the canvas point under the mouse in place
+    void update(Uint64 nowMs);
+    // Returns true if the event was used to pan or zoom, and shouldn't reach the editor
+    bool handleEvent(const SDL_Event* event);
+
+private:
+    float targetZoom = 1.0f;
+    SDL_FPoint anchorScreen{}, anchorWorld{}; // The point zoomed around, in both spaces
+    bool panning = false;
+    Uint64 lastUpdateMs = 0;
+};
+
+extern Camera camera;
+
+#endif //CAMERA_HPP
@@ -0,0 +1,247 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Checkpoint.hpp"
+#include "Simulator.hpp"
+#include "CycleSimulator.hpp"
+
+#include <cstring>
+
+static constexpr Uint8 CHECKPOINT_MAGIC[4] = {'L', 'S', 'C', 'K'};
+static constexpr Uint32 CHECKPOINT_FORMAT = 4;
+
+template<typename T>
+static void put(std::vector<Uint8>& out, const T value) {
+    const auto* bytes = reinterpret_cast<const Uint8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Bounds-checked reader over a checkpoint blob
+struct CheckpointReader {
+    const Uint8* data;
+    size_t size;
+    size_t offset = 0;
+
+    template<typename T>
+    bool get(T& value) {
+        if (size - offset < sizeof(T)) return false;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    const Uint8* take(const size_t n) {
+        if (size - offset < n) return nullptr;
+        const Uint8* ptr = data + offset;
+        offset += n;
+        return ptr;
+    }
+};
+
+std::vector<Uint8> saveCheckpoint() {
+    const size_t slots = objectSlots.capacity();
+
+    std::vector<Uint8> out;
+    out.reserve(64 + slots / 8 + (eventQueue.size() + sequentialQueue.size()) * sizeof(ObjectHandle));
+    out.insert(out.end(), std::begin(CHECKPOINT_MAGIC), std::end(CHECKPOINT_MAGIC));
+    put(out, CHECKPOINT_FORMAT);
+    put(out, netlistVersion);
+    put(out, simTime);
+    put(out, static_cast<Uint64>(deltaRemaining));
+    put(out, static_cast<Uint64>(slots));
+
+    // Object states, one bit each by handle slot. Free slots are left 0.
+    const size_t bitsOffset = out.size();
+    out.resize(out.size() + (slots + 7) / 8, 0);
+    for (const auto* obj : objects) {
+        const Uint32 slot = obj->handle.slot;
+        out[bitsOffset + slot / 8] |= static_cast<Uint8>(obj->state()) << (slot % 8);
+    }
+
+    // Events of deleted objects are dropped, they would be skipped anyway
+    std::queue<ObjectHandle> pending = eventQueue;
+    std::vector<ObjectHandle> queued;
+    queued.reserve(pending.size());
+    while (!pending.empty()) {
+        if (objectSlots.get(pending.front())) queued.push_back(pending.front());
+        pending.pop();
+    }
+    put(out, static_cast<Uint64>(queued.size()));
+    for (const ObjectHandle handle : queued) {
+        put(out, handle.slot);
+        put(out, handle.generation);
+    }
+
+    put(out, static_cast<Uint64>(sequentialQueue.size()));
+    for (const auto* obj : sequentialQueue) {
+        put(out, obj->handle.slot);
+        put(out, obj->handle.generation);
+    }
+
+    // Internal state of objects that have any, as (slot, generation, size, bytes) records
+    const size_t recordCountOffset = out.size();
+    put(out, static_cast<Uint64>(0));
+    Uint64 records = 0;
+    std::vector<Uint8> extra;
+    for (const auto* obj : objects) {
+        extra.clear();
+        obj->saveState(extra);
+        if (extra.empty()) continue;
+        put(out, obj->handle.slot);
+        put(out, obj->handle.generation);
+        put(out, static_cast<Uint32>(extra.size()));
+        out.insert(out.end(), extra.begin(), extra.end());
+        records++;
+    }
+    std::memcpy(out.data() + recordCountOffset, &records, sizeof(records));
+
+    const CycleSimulator::Phase phase = cycleSimulator.phase();
+    put(out, phase.edges);
+    put(out, phase.pendingEdges);
+    return out;
+}
+
+/**
+ * @brief Restores the simulation to a checkpoint taken with saveCheckpoint().
+ * @param data Checkpoint blob.
+ * @param size Size of the blob in bytes.
+ * @return false if the blob is malformed or was taken from a different circuit.
+ */
+bool restoreCheckpoint(const Uint8* data, const size_t size) {
+    CheckpointReader reader{data, size};
+
+    const Uint8* magic = reader.take(sizeof(CHECKPOINT_MAGIC));
+    Uint32 format = 0;
+    Uint64 version = 0, time = 0, delta = 0, slots = 0;
+    if (!magic || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+        !reader.get(format) || format != CHECKPOINT_FORMAT) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Not a checkpoint, or an unsupported checkpoint format.");
+        return false;
+    }
+    if (!reader.get(version) || !reader.get(time) || !reader.get(delta) || !reader.get(slots)) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Truncated checkpoint header.");
+        return false;
+    }
+    if (version != netlistVersion || slots != objectSlots.capacity()) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Checkpoint was taken from a different circuit.");
+        return false;
+    }
+
+    // Everything is read and checked before anything is changed, so that a truncated or corrupt
+    // checkpoint leaves the simulation as it was. Every handle must resolve to a live object.
+    struct Record {
+        Object* obj;
+        Uint32 length;
+        const Uint8* data;
+    };
+    const auto readObject = [&](Object*& obj) {
+        ObjectHandle handle;
+        if (!reader.get(handle.slot) || !reader.get(handle.generation)) return false;
+        obj = objectSlots.get(handle);
+        return obj != nullptr;
+    };
+    const auto readObjects = [&](std::vector<Object*>& objs) {
+        Uint64 n = 0;
+        if (!reader.get(n) || n > (size - reader.offset) / sizeof(ObjectHandle)) return false;
+        objs.resize(n);
+        for (auto& obj : objs) {
+            if (!readObject(obj)) return false;
+        }
+        return true;
+    };
+
+    const Uint8* bits = reader.take((slots + 7) / 8);
+    std::vector<Object*> queued, sequential;
+    std::vector<Record> records;
+    Uint64 recordCount = 0;
+    bool valid = bits && readObjects(queued) && readObjects(sequential) && reader.get(recordCount);
+    for (Uint64 i = 0; valid && i < recordCount; ++i) {
+        Record record{};
+        valid = readObject(record.obj) && reader.get(record.length) &&
+                (record.data = reader.take(record.length)) != nullptr;
+        records.push_back(record);
+    }
+    CycleSimulator::Phase phase{};
+    valid = valid && reader.get(phase.edges) && reader.get(phase.pendingEdges);
+    if (!valid) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Truncated or corrupt checkpoint.");
+        return false;
+    }
+
+    // Only the objects can still reject their internal state. What they held before is kept, to be
+    // put back if one of them does.
+    std::vector<std::vector<Uint8>> previous(records.size());
+    std::vector<std::vector<Uint8>> memories(records.size()); // Old contents of the RAMs
+    for (size_t i = 0; i < records.size(); ++i) {
+        Object* obj = records[i].obj;
+        obj->saveState(previous[i]);
+        if (obj->kind == KIND_RAM) memories[i] = static_cast<const Ram*>(obj)->memory;
+        if (obj->loadState(records[i].data, records[i].length)) continue;
+
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Checkpoint state of %s does not match.", objectName(obj).c_str());
+        for (size_t k = 0; k <= i; ++k) {
+            records[k].obj->loadState(previous[k].data(), previous[k].size());
+        }
+        return false;
+    }
+
+    // The listeners see the restore as changes made at the restored time, like any other
+    simTime = time;
+    for (auto* obj : objects) {
+        const bool state = bits[obj->handle.slot / 8] >> (obj->handle.slot % 8) & 1;
+        obj->queued() = false;
+        if (obj->state() == state) continue;
+        obj->state() = state;
+        notifyChange(obj);
+    }
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i].obj->kind != KIND_RAM) continue;
+        const auto* ram = static_cast<const Ram*>(records[i].obj);
+        for (Uint32 address = 0; address < ram->memory.size(); ++address) {
+            if (ram->memory[address] == memories[i][address]) continue;
+            notifyMemoryWrite(ram, address, memories[i][address], ram->memory[address]);
+        }
+    }
+    eventQueue = {};
+    for (auto* obj : queued) {
+        eventQueue.push(obj->handle);
+        obj->queued() = true;
+    }
+    sequentialQueue.clear();
+    for (auto* obj : sequential) {
+        sequentialQueue.push_back(obj);
+        obj->queued() = true;
+    }
+
+    deltaRemaining = static_cast<size_t>(delta);
+    cycleSimulator.setPhase(phase);
+    return true;
+}
+
+bool saveCheckpointFile(const char* path) {
+    const std::vector<Uint8> blob = saveCheckpoint();
+    if (!SDL_SaveFile(path, blob.data(), blob.size())) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to write checkpoint %s: %s", path, SDL_GetError());
+        return false;
+    }
+    SDL_Log("Saved checkpoint %s at time %llu (%zu bytes).", path, static_cast<unsigned long long>(simTime),
+            blob.size());
+    return true;
+}
+
+bool loadCheckpointFile(const char* path) {
+    size_t size = 0;
+    void* data = SDL_LoadFile(path, &size);
+    if (!data) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to read checkpoint %s: %s", path, SDL_GetError());
+        return false;
+    }
+    const bool restored = restoreCheckpoint(static_cast<const Uint8*>(data), size);
+    SDL_free(data);
+    if (restored) {
+        SDL_Log("Restored checkpoint %s at time %llu.", path, static_cast<unsigned long long>(simTime));
+    }
+    return restored;
+}
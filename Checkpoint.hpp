@@ -0,0 +1,23 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+// A checkpoint is a compact binary snapshot of a running simulation: the state of every
+// object packed one bit each, the pending event and sequential queues, the virtual time, any
+// internal object state such as memory contents, and the clock phase of the cycle engine. Objects
+// are referred to by handle, so the order of the objects vector doesn't matter. It can only be
+// restored into the same circuit it was taken from. Restoring reports every state and memory word
+// it changes to the changeListeners.
+
+extern std::vector<Uint8> saveCheckpoint();
+extern bool restoreCheckpoint(const Uint8* data, size_t size);
+extern bool saveCheckpointFile(const char* path);
+extern bool loadCheckpointFile(const char* path);
+
+#endif //CHECKPOINT_HPP
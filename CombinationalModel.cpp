@@ -0,0 +1,157 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "CombinationalModel.hpp"
+#include "Logic.hpp"
+#include "Netlist.hpp"
+
+#include <algorithm>
+
+Uint32 CombinationalModel::signal(const Uint32 node, const Uint32 pin) const {
+    const Uint32 count = signalStart[node + 1] - signalStart[node];
+    return signalStart[node] + std::min(pin, count - 1);
+}
+
+// Appends a model pin carrying the sources of input pin `pin` of the given netlist node
+void CombinationalModel::addPin(const Netlist& netlist, const Uint32 node, const Uint32 pin) {
+    const Uint32 p = netlist.pinStart[node] + pin;
+    pinSourceStart.push_back(static_cast<Uint32>(pinSources.size()));
+    for (Uint32 e = netlist.faninStart[p]; e < netlist.faninStart[p + 1]; ++e) {
+        pinSources.push_back(signal(netlist.fanin[e], netlist.faninPin[e]));
+    }
+}
+
+bool CombinationalModel::compile(const Netlist& netlist) {
+    const auto n = static_cast<Uint32>(netlist.nodes.size());
+    nodes = netlist.nodes;
+    inputs.clear();
+    inputNames.clear();
+    cells.clear();
+    outputs.clear();
+    outputNames.clear();
+    pinSourceStart.clear();
+    pinSources.clear();
+    version = netlist.version;
+
+    if (netlist.cyclic > 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Cannot build a combinational model of a circuit with combinational loops.");
+        signalCount = 0;
+        signalStart.assign(n + 1, 0);
+        fanoutStart.assign(1, 0);
+        fanout.clear();
+        driver.clear();
+        return false;
+    }
+
+    signalStart.assign(n + 1, 0);
+    for (Uint32 i = 0; i < n; ++i) {
+        signalStart[i + 1] = signalStart[i] + static_cast<Uint32>(std::max<size_t>(1, nodes[i]->outputPins.size()));
+    }
+    signalCount = signalStart[n];
+
+    // Everything but gates, wires and leds cuts the graph
+    std::vector<Uint32> boundary;
+    for (Uint32 i = 0; i < n; ++i) {
+        Object* obj = nodes[i];
+        if (obj->kind == KIND_GATE || obj->kind == KIND_WIRE || obj->kind == KIND_LED) continue;
+        if (obj->kind == KIND_FAKE) continue;
+        boundary.push_back(i);
+
+        const bool flipFlop = obj->kind == KIND_FLIPFLOP;
+        const std::string name = objectName(obj);
+        const Uint32 count = signalStart[i + 1] - signalStart[i];
+        if (flipFlop || count == 1) {
+            inputs.push_back(signalStart[i]);
+            inputNames.push_back(name);
+        } else {
+            for (Uint32 pin = 0; pin < count; ++pin) {
+                inputs.push_back(signalStart[i] + pin);
+                inputNames.push_back(name + "[" + std::to_string(pin) + "]");
+            }
+        }
+
+        // /Q follows Q, so it isn't a free input
+        if (flipFlop && count > 1) {
+            cells.push_back({i, signalStart[i] + 1, static_cast<Uint32>(pinSourceStart.size()), 1, NOT, false});
+            pinSourceStart.push_back(static_cast<Uint32>(pinSources.size()));
+            pinSources.push_back(signalStart[i]);
+        }
+    }
+
+    for (const Uint32 i : netlist.order) {
+        Object* obj = nodes[i];
+        if (obj->kind == KIND_GATE) {
+            const auto* gate = static_cast<const Gate*>(obj);
+            const size_t arity = gate->type == BUF || gate->type == NOT ? 1 : 2;
+            const auto pins = static_cast<Uint8>(std::min(arity, gate->inputPins.size()));
+            cells.push_back({i, signalStart[i], static_cast<Uint32>(pinSourceStart.size()), pins, gate->type, true});
+            for (Uint32 pin = 0; pin < pins; ++pin) addPin(netlist, i, pin);
+        } else if (obj->kind == KIND_WIRE) {
+            cells.push_back({i, signalStart[i], static_cast<Uint32>(pinSourceStart.size()), 1, BUF, false});
+            addPin(netlist, i, 0);
+        }
+    }
+
+    for (const Uint32 i : netlist.outputs) {
+        if (nodes[i]->inputPins.empty()) continue;
+        outputs.push_back(static_cast<Uint32>(pinSourceStart.size()));
+        outputNames.push_back(objectName(nodes[i]));
+        addPin(netlist, i, 0);
+    }
+    for (const Uint32 i : boundary) {
+        const std::string name = objectName(nodes[i]);
+        for (Uint32 pin = 0; pin < nodes[i]->inputPins.size(); ++pin) {
+            outputs.push_back(static_cast<Uint32>(pinSourceStart.size()));
+            outputNames.push_back(name + ".in" + std::to_string(pin));
+            addPin(netlist, i, pin);
+        }
+    }
+    pinSourceStart.push_back(static_cast<Uint32>(pinSources.size()));
+
+    fanoutStart.assign(signalCount + 1, 0);
+    for (const auto& cell : cells) {
+        for (Uint32 p = cell.pinStart; p < cell.pinStart + cell.pins; ++p) {
+            for (Uint32 s = pinSourceStart[p]; s < pinSourceStart[p + 1]; ++s) fanoutStart[pinSources[s] + 1]++;
+        }
+    }
+    for (size_t s = 0; s < signalCount; ++s) fanoutStart[s + 1] += fanoutStart[s];
+    fanout.assign(fanoutStart[signalCount], 0);
+    std::vector<Uint32> fill(fanoutStart.begin(), fanoutStart.end() - 1);
+    for (Uint32 c = 0; c < cells.size(); ++c) {
+        const auto& cell = cells[c];
+        for (Uint32 p = cell.pinStart; p < cell.pinStart + cell.pins; ++p) {
+            for (Uint32 s = pinSourceStart[p]; s < pinSourceStart[p + 1]; ++s) fanout[fill[pinSources[s]]++] = c;
+        }
+    }
+
+    driver.assign(signalCount, -1);
+    for (Uint32 c = 0; c < cells.size(); ++c) driver[cells[c].signal] = static_cast<Sint32>(c);
+    return true;
+}
+
+int CombinationalModel::findInput(const std::string& name) const {
+    const auto it = std::ranges::find(inputNames, name);
+    return it == inputNames.end() ? -1 : static_cast<int>(it - inputNames.begin());
+}
+
+std::vector<bool> CombinationalModel::evaluate(const Pattern& pattern) const {
+    std::vector<Uint64> values(signalCount, 0);
+    for (size_t i = 0; i < inputs.size() && i < pattern.size(); ++i) values[inputs[i]] = pattern[i];
+
+    const auto evalPin = [&](const Uint32 pin) {
+        Uint64 value = 0;
+        for (Uint32 s = pinSourceStart[pin]; s < pinSourceStart[pin + 1]; ++s) value |= values[pinSources[s]];
+        return value;
+    };
+    for (const auto& cell : cells) {
+        const Uint64 a = cell.pins > 0 ? evalPin(cell.pinStart) : 0;
+        const Uint64 b = cell.pins > 1 ? evalPin(cell.pinStart + 1) : 0;
+        values[cell.signal] = gateFunction(cell.type, a, b) & 1;
+    }
+
+    std::vector<bool> response(outputs.size());
+    for (size_t o = 0; o < outputs.size(); ++o) response[o] = evalPin(outputs[o]) & 1;
+    return response;
+}
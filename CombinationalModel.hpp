@@ -0,0 +1,72 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef COMBINATIONALMODEL_HPP
+#define COMBINATIONALMODEL_HPP
+
+#include <SDL3/SDL.h>
+#include <string>
+#include <vector>
+
+#include "Simulator.hpp"
+
+class Netlist;
+
+// One value per model input, in the order of CombinationalModel::inputs
+using Pattern = std::vector<bool>;
+
+// Combinational view of a netlist, used for fault grading and test generation. Flip-flops and
+// memories are assumed to sit on a full scan chain: their outputs become pseudo-primary inputs and
+// their input pins pseudo-primary outputs, next to the buttons, clocks and leds. What is left in
+// between is a DAG of cells, each driving one signal.
+class CombinationalModel {
+public:
+    struct Cell {
+        Uint32 node; // Netlist node the cell was built from
+        Uint32 signal; // Signal driven by the cell
+        Uint32 pinStart; // First model pin, see pinSourceStart
+        Uint8 pins;
+        GateType type; // Wires are buffers, the /Q output of a flip-flop is an inverter
+        bool gate; // Built from a Gate, and therefore a fault site
+    };
+
+    std::vector<Object*> nodes;
+    size_t signalCount = 0;
+    std::vector<Uint32> signalStart; // Output pin p of node i drives signal signalStart[i] + p
+
+    std::vector<Uint32> inputs; // Signals set by a pattern
+    std::vector<std::string> inputNames;
+    std::vector<Cell> cells; // In evaluation order
+    std::vector<Uint32> outputs; // Observed model pins
+    std::vector<std::string> outputNames;
+
+    // Model pin p is the wired OR of the signals pinSources[pinSourceStart[p]] .. pinSources[pinSourceStart[p + 1] - 1]
+    std::vector<Uint32> pinSourceStart;
+    std::vector<Uint32> pinSources;
+
+    // Cells reading signal s are fanout[fanoutStart[s]] .. fanout[fanoutStart[s + 1] - 1]
+    std::vector<Uint32> fanoutStart;
+    std::vector<Uint32> fanout;
+    std::vector<Sint32> driver; // Cell driving each signal, -1 for inputs
+
+    Uint64 version = 0; // netlistVersion of the netlist the model was built from
+
+    /**
+     * @brief Builds the model from a compiled netlist.
+     * @return false if the netlist has combinational loops, which the model cannot represent.
+     */
+    bool compile(const Netlist& netlist);
+    bool isStale() const { return version != netlistVersion; }
+
+    // Index into inputs of the given name, or -1
+    int findInput(const std::string& name) const;
+    // Fault-free response of the outputs to a pattern
+    std::vector<bool> evaluate(const Pattern& pattern) const;
+
+private:
+    Uint32 signal(Uint32 node, Uint32 pin) const;
+    void addPin(const Netlist& netlist, Uint32 node, Uint32 pin);
+};
+
+#endif //COMBINATIONALMODEL_HPP
@@ -0,0 +1,208 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "CompiledCircuit.hpp"
+#include "Activity.hpp"
+#include "Logic.hpp"
+#include "Simulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr Uint8 LAST_CLOCK = 1;
+static constexpr Uint8 NEXT_STATE = 2;
+
+void CompiledCircuit::compile(const std::vector<Object*>& objects) {
+    netlist.compile(objects);
+    clockCone = netlist.clockCone();
+
+    const size_t n = netlist.nodes.size();
+    kind.assign(n, OTHER);
+    param.assign(n, 0);
+    memoryStart.assign(n, 0);
+    romData.clear();
+    romSize.clear();
+    initialState.assign(n, 0);
+    initialWord.assign(n, 0);
+    initialFlags.assign(n, 0);
+    initialMemory.clear();
+
+    for (size_t i = 0; i < n; ++i) {
+        Object* obj = netlist.nodes[i];
+        initialState[i] = obj->state();
+        switch (obj->kind) {
+            case KIND_BUTTON: kind[i] = BUTTON; break;
+            case KIND_CLOCK: kind[i] = CLOCK; break;
+            case KIND_WIRE: kind[i] = WIRE; break;
+            case KIND_LED: kind[i] = LED; break;
+            case KIND_GATE:
+                kind[i] = GATE;
+                param[i] = static_cast<const Gate*>(obj)->type;
+                break;
+            case KIND_FLIPFLOP: {
+                const auto* flipFlop = static_cast<const FlipFlop*>(obj);
+                kind[i] = FLIPFLOP;
+                param[i] = flipFlop->type;
+                initialFlags[i] = (flipFlop->lastClock ? LAST_CLOCK : 0) | (flipFlop->nextState ? NEXT_STATE : 0);
+                break;
+            }
+            case KIND_RAM: {
+                const auto* ram = static_cast<const Ram*>(obj);
+                kind[i] = RAM;
+                param[i] = static_cast<Uint8>(ram->addressBits);
+                memoryStart[i] = static_cast<Uint32>(initialMemory.size());
+                initialMemory.insert(initialMemory.end(), ram->memory.begin(), ram->memory.end());
+                initialWord[i] = ram->output;
+                break;
+            }
+            case KIND_ROM: {
+                const auto* rom = static_cast<const Rom*>(obj);
+                kind[i] = ROM;
+                param[i] = static_cast<Uint8>(rom->addressBits);
+                memoryStart[i] = static_cast<Uint32>(romData.size());
+                romData.push_back(rom->data);
+                romSize.push_back(rom->size);
+                initialWord[i] = rom->output;
+                break;
+            }
+            default: break;
+        }
+    }
+
+    float fastestFreq = 0.0f;
+    for (const Uint32 node : netlist.clocks) {
+        fastestFreq = std::max(fastestFreq, static_cast<Clock*>(netlist.nodes[node])->freq);
+    }
+    clockDivider.clear();
+    for (const Uint32 node : netlist.clocks) {
+        const float freq = static_cast<Clock*>(netlist.nodes[node])->freq;
+        const float ratio = freq > 0.0f ? fastestFreq / freq : 0.0f;
+        clockDivider.push_back(std::max<Uint64>(1, static_cast<Uint64>(std::lround(ratio))));
+    }
+}
+
+CircuitInstance::CircuitInstance(const CompiledCircuit& circuit) : circuit(circuit) {
+    reset();
+}
+
+void CircuitInstance::reset() {
+    state = circuit.initialState;
+    word = circuit.initialWord;
+    flags = circuit.initialFlags;
+    memory = circuit.initialMemory;
+    wordMask.assign(state.size(), 0);
+    wordForced.assign(state.size(), 0);
+    edges = 0;
+    if (toggleCounter) toggleCounter->restart(state.data());
+}
+
+void CircuitInstance::countToggles(ToggleCounter* counter) {
+    toggleCounter = counter;
+    if (toggleCounter) toggleCounter->restart(state.data());
+}
+
+void CircuitInstance::force(const Uint32 node, const bool value) {
+    state[node] = value;
+    if (circuit.kind[node] == CompiledCircuit::FLIPFLOP) {
+        flags[node] = (flags[node] & LAST_CLOCK) | (value ? NEXT_STATE : 0);
+    }
+}
+
+void CircuitInstance::forceWord(const Uint32 node, const Uint32 bit, const bool value) {
+    const auto mask = static_cast<Uint8>(1u << bit);
+    wordMask[node] |= mask;
+    wordForced[node] = (wordForced[node] & ~mask) | (value ? mask : 0);
+    word[node] = (word[node] & ~mask) | (value ? mask : 0);
+    state[node] = word[node] != 0;
+}
+
+bool CircuitInstance::getOutput(const Uint32 node, const Uint16 pin) const {
+    switch (circuit.kind[node]) {
+        case CompiledCircuit::FLIPFLOP: return pin == 0 ? state[node] : !state[node];
+        case CompiledCircuit::RAM:
+        case CompiledCircuit::ROM: return (word[node] >> pin) & 1;
+        default: return state[node];
+    }
+}
+
+bool CircuitInstance::evalPin(const Uint32 pin) const {
+    const auto& netlist = circuit.netlist;
+    for (Uint32 e = netlist.faninStart[pin]; e < netlist.faninStart[pin + 1]; ++e) {
+        if (getOutput(netlist.fanin[e], netlist.faninPin[e])) return true;
+    }
+    return false;
+}
+
+// Same semantics as the objects, see Logic.hpp
+void CircuitInstance::eval(const Uint32 node) {
+    const Uint32 pins = circuit.netlist.pinStart[node];
+    const Uint32 pinCount = circuit.netlist.pinStart[node + 1] - pins;
+    const auto pin = [&](const Uint32 i) { return evalPin(pins + i); };
+    const auto connected = [&](const Uint32 i) {
+        return i < pinCount && circuit.netlist.faninStart[pins + i] != circuit.netlist.faninStart[pins + i + 1];
+    };
+
+    switch (circuit.kind[node]) {
+        case CompiledCircuit::GATE: {
+            bool out;
+            if (evalGate(static_cast<GateType>(circuit.param[node]), pin, connected, out)) state[node] = out;
+            break;
+        }
+        case CompiledCircuit::WIRE:
+        case CompiledCircuit::LED:
+            state[node] = pinCount > 0 && evalPin(pins);
+            break;
+        case CompiledCircuit::RAM: {
+            const int bits = circuit.param[node];
+            const Uint32 address = memoryAddress(bits, pin);
+            Uint8* contents = memory.data() + circuit.memoryStart[node];
+            ramWrite(bits, pin, contents[address]);
+            word[node] = (contents[address] & ~wordMask[node]) | wordForced[node];
+            state[node] = word[node] != 0;
+            break;
+        }
+        case CompiledCircuit::ROM: {
+            const Uint32 rom = circuit.memoryStart[node];
+            const Uint8 data = romWord(circuit.romData[rom], circuit.romSize[rom], memoryAddress(circuit.param[node], pin));
+            word[node] = (data & ~wordMask[node]) | wordForced[node];
+            state[node] = word[node] != 0;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void CircuitInstance::sample(const Uint32 node) {
+    const Uint32 pins = circuit.netlist.pinStart[node];
+    bool lastClock = flags[node] & LAST_CLOCK;
+    const bool next = sampleFlipFlop(static_cast<FlipFlopType>(circuit.param[node]), state[node], lastClock,
+                                     [&](const Uint32 i) { return evalPin(pins + i); });
+    flags[node] = (lastClock ? LAST_CLOCK : 0) | (next ? NEXT_STATE : 0);
+}
+
+void CircuitInstance::settle() {
+    for (const Uint32 node : circuit.netlist.order) eval(node);
+}
+
+// Same steps as CycleSimulator::edge()
+void CircuitInstance::edge() {
+    const auto& clocks = circuit.netlist.clocks;
+    for (size_t i = 0; i < clocks.size(); ++i) {
+        if (edges % circuit.clockDivider[i] == 0) state[clocks[i]] ^= 1;
+    }
+    edges++;
+
+    for (const Uint32 node : circuit.clockCone) eval(node);
+    for (const Uint32 node : circuit.netlist.sequential) {
+        if (circuit.kind[node] == CompiledCircuit::FLIPFLOP) sample(node);
+    }
+    for (const Uint32 node : circuit.netlist.sequential) {
+        if (circuit.kind[node] == CompiledCircuit::FLIPFLOP) state[node] = (flags[node] & NEXT_STATE) != 0;
+    }
+    settle();
+
+    if (toggleCounter) toggleCounter->sample(state.data());
+}
@@ -0,0 +1,94 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef COMPILEDCIRCUIT_HPP
+#define COMPILEDCIRCUIT_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "Netlist.hpp"
+
+class ToggleCounter;
+
+// A read-only copy of the circuit that CircuitInstances simulate, with the same cycle-based
+// semantics as CycleSimulator. Unlike the editor objects it can be shared between threads:
+// every instance keeps its own states and memory contents.
+class CompiledCircuit {
+public:
+    enum Kind : Uint8 { BUTTON, CLOCK, GATE, WIRE, LED, FLIPFLOP, RAM, ROM, OTHER };
+
+    Netlist netlist;
+    std::vector<Kind> kind;
+    std::vector<Uint8> param; // GateType, FlipFlopType, or the address bits of a memory
+    std::vector<Uint32> clockCone;
+    std::vector<Uint64> clockDivider; // Per clock, edges of the fastest clock per edge of this one
+
+    // Per RAM node, offset of its contents in the instance memory. Per ROM node, offset into roms.
+    std::vector<Uint32> memoryStart;
+    std::vector<const Uint8*> romData;
+    std::vector<size_t> romSize;
+
+    // States of the objects at compile time, which instances start from
+    std::vector<Uint8> initialState;
+    std::vector<Uint8> initialWord; // Outputs of memories
+    std::vector<Uint8> initialFlags; // Flip-flop lastClock and nextState
+    std::vector<Uint8> initialMemory;
+
+    // The ROM images are referenced, not copied, so the circuit must not outlive the objects
+    void compile(const std::vector<Object*>& objects);
+};
+
+class CircuitInstance {
+public:
+    Uint64 edges = 0;
+
+    explicit CircuitInstance(const CompiledCircuit& circuit);
+
+    // Restores the states the circuit was compiled with
+    void reset();
+
+    // Inputs and outputs are numbered like netlist.inputs and netlist.outputs
+    void setInput(size_t input, bool value) { state[circuit.netlist.inputs[input]] = value; }
+    bool input(size_t input) const { return state[circuit.netlist.inputs[input]]; }
+    bool output(size_t output) const { return state[circuit.netlist.outputs[output]]; }
+    bool value(Uint32 node) const { return state[node]; }
+    // Value seen by input pin `pin` of a node
+    bool pinValue(Uint32 node, Uint32 pin) const { return evalPin(circuit.netlist.pinStart[node] + pin); }
+    // Overrides the state of any node, e.g. to load a flip-flop as if through a scan chain
+    void force(Uint32 node, bool value);
+    // Holds output bit `bit` of a memory at the given value until reset(), as if its output word were
+    // loaded through a scan chain. Reading the memory no longer changes that bit.
+    void forceWord(Uint32 node, Uint32 bit, bool value);
+
+    // Evaluates the combinational logic after inputs were changed
+    void settle();
+    // Simulates one edge of the fastest clock
+    void edge();
+    // Samples the node states into the counter after every edge, or stops sampling for nullptr
+    void countToggles(ToggleCounter* counter);
+
+    // Simulates a full period of the fastest clock
+    void cycle() {
+        edge();
+        edge();
+    }
+
+private:
+    const CompiledCircuit& circuit;
+    std::vector<Uint8> state;
+    std::vector<Uint8> word;
+    std::vector<Uint8> flags;
+    std::vector<Uint8> memory;
+    std::vector<Uint8> wordMask; // Per memory node, the bits of word held by forceWord()
+    std::vector<Uint8> wordForced;
+    ToggleCounter* toggleCounter = nullptr;
+
+    bool getOutput(Uint32 node, Uint16 pin) const;
+    bool evalPin(Uint32 pin) const;
+    void eval(Uint32 node);
+    void sample(Uint32 node);
+};
+
+#endif //COMPILEDCIRCUIT_HPP
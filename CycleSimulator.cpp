@@ -0,0 +1,169 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "CycleSimulator.hpp"
+#include "Simulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void CycleSimulator::compile() {
+    // After an edit only the logic downstream of it is re-levelized and settled again, and the
+    // copies below are patched where the netlist changed instead of being rebuilt
+    const Uint64 since = netlist.version;
+    const bool patch = netlist.update(objects) &&
+                       order.size() + netlist.orderInserted.size() == netlist.order.size() + netlist.orderRemoved.size();
+    if (patch) {
+        patchOrder();
+    } else {
+        order.clear();
+        order.reserve(netlist.order.size());
+        for (const Uint32 node : netlist.order) {
+            order.push_back(netlist.nodes[node]);
+        }
+    }
+
+    if (!patch || netlist.sourcesChanged) {
+        const std::vector<Uint64> previousDivider = std::move(clockDivider);
+        sequential.clear();
+        for (const Uint32 node : netlist.sequential) {
+            sequential.push_back(netlist.nodes[node]);
+        }
+
+        clocks.clear();
+        fastestFreq = 0.0f;
+        for (const Uint32 node : netlist.clocks) {
+            auto* clk = static_cast<Clock*>(netlist.nodes[node]);
+            clocks.push_back(clk);
+            fastestFreq = std::max(fastestFreq, clk->freq);
+        }
+        clockDivider.clear();
+        for (const auto* clk : clocks) {
+            const float ratio = clk->freq > 0.0f ? fastestFreq / clk->freq : 0.0f;
+            clockDivider.push_back(std::max<Uint64>(1, static_cast<Uint64>(std::lround(ratio))));
+        }
+        // Edits elsewhere leave the clocks in phase; only new dividers count from the start again
+        if (clockDivider != previousDivider) edges = 0;
+    }
+
+    // These are re-evaluated before the flip-flops sample, so they see the new clock level
+    if (!patch || coneEdited(since)) {
+        clockCone.clear();
+        coneSlots.assign(objectSlots.capacity(), false);
+        for (const Uint32 node : netlist.clockCone()) {
+            clockCone.push_back(netlist.nodes[node]);
+            coneSlots[netlist.nodes[node]->handle.slot] = true;
+        }
+    }
+
+    // Settle the combinational logic so the first edge samples consistent values
+    for (const Uint32 node : netlist.affected) {
+        evalAndNotify(netlist.nodes[node]);
+    }
+
+    SDL_Log("Compiled %zu objects for cycle-based simulation (%zu sequential, %zu clocks).",
+            order.size(), sequential.size(), clocks.size());
+}
+
+// Replays on order what the last Netlist::update() did to netlist.order, moving the untouched
+// stretches in between as whole blocks
+void CycleSimulator::patchOrder() {
+    if (netlist.orderRemoved.empty() && netlist.orderInserted.empty()) return;
+
+    auto kept = order.begin();
+    auto from = order.begin();
+    for (const Uint32 position : netlist.orderRemoved) {
+        kept = std::move(from, order.begin() + position, kept);
+        from = order.begin() + position + 1;
+    }
+    kept = std::move(from, order.end(), kept);
+    order.erase(kept, order.end());
+
+    std::vector<Object*> patched(netlist.order.size());
+    from = order.begin();
+    auto to = patched.begin();
+    for (const Uint32 position : netlist.orderInserted) {
+        const auto stretch = patched.begin() + position - to;
+        to = std::copy(from, from + stretch, to);
+        from += stretch;
+        *to++ = netlist.nodes[netlist.order[position]];
+    }
+    std::copy(from, order.end(), to);
+    order = std::move(patched);
+}
+
+// Whether the last update may have changed the clock cone: a clock was added or connected, or
+// a re-levelized node is in the cone or driven from it. Deleting a node of the cone edits its
+// driver, which is one of these.
+bool CycleSimulator::coneEdited(const Uint64 since) const {
+    for (const auto* clk : clocks) {
+        if (clk->edited > since) return true;
+    }
+    const auto inCone = [&](const Uint32 node) {
+        const Object* obj = netlist.nodes[node];
+        return obj->kind == KIND_CLOCK || (obj->handle.slot < coneSlots.size() && coneSlots[obj->handle.slot]);
+    };
+    for (const Uint32 node : netlist.affected) {
+        if (inCone(node)) return true;
+        for (Uint32 e = netlist.faninStart[netlist.pinStart[node]]; e < netlist.faninStart[netlist.pinStart[node + 1]]; ++e) {
+            if (inCone(netlist.fanin[e])) return true;
+        }
+    }
+    return false;
+}
+
+void CycleSimulator::edge() {
+    for (size_t i = 0; i < clocks.size(); ++i) {
+        if (edges % clockDivider[i] == 0) {
+            clocks[i]->state() = !clocks[i]->state();
+            notifyChange(clocks[i]);
+        }
+    }
+    edges++;
+
+    for (auto* obj : clockCone) {
+        evalAndNotify(obj);
+    }
+
+    // Sample everything first so that no flip-flop sees another one's new state
+    for (auto* obj : sequential) {
+        obj->sample();
+    }
+    for (auto* obj : sequential) {
+        if (obj->commit()) notifyChange(obj);
+    }
+
+    for (auto* obj : order) {
+        evalAndNotify(obj);
+    }
+
+    advanceTime();
+}
+
+void CycleSimulator::run(const Uint64 cycles) {
+    for (Uint64 i = 0; i < cycles * 2; ++i) {
+        edge();
+    }
+}
+
+/**
+ * @brief Runs the edges that are due in real time, so the circuit ticks at the rate of its clocks.
+ * @param nowMs Current time in milliseconds, e.g. from SDL_GetTicks().
+ */
+void CycleSimulator::advance(const Uint64 nowMs) {
+    if (lastAdvanceMs == 0 || fastestFreq <= 0.0f) {
+        lastAdvanceMs = nowMs;
+        return;
+    }
+
+    // Don't try to catch up on more than a second of simulated time after a stall
+    pendingEdges += static_cast<double>(nowMs - lastAdvanceMs) * fastestFreq * 2.0 / 1000.0;
+    pendingEdges = std::min(pendingEdges, static_cast<double>(fastestFreq) * 2.0);
+    lastAdvanceMs = nowMs;
+    while (pendingEdges >= 1.0) {
+        edge();
+        pendingEdges -= 1.0;
+    }
+}
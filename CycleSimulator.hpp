@@ -0,0 +1,62 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef CYCLESIMULATOR_HPP
+#define CYCLESIMULATOR_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "Netlist.hpp"
+
+class Object;
+class Clock;
+
+// Cycle-based engine for synchronous designs. On every clock edge the flip-flops latch and
+// then each combinational object is evaluated exactly once in topological order, so glitches
+// inside a cycle are ignored. It drives the same Gate/Clock objects as the event-driven loop.
+class CycleSimulator {
+public:
+    // Where the engine is in the periods of the clocks, which checkpoints save along with the states
+    struct Phase {
+        Uint64 edges;
+        double pendingEdges;
+    };
+
+    Netlist netlist;
+    Uint64 edges = 0; // Clock edges simulated since the clock dividers last changed
+
+    void compile();
+
+    // Simulates a single edge of the fastest clock.
+    void edge();
+    // Simulates n full periods of the fastest clock.
+    void run(Uint64 cycles);
+    // Simulates as many edges as the clock frequencies call for since the last call.
+    void advance(Uint64 nowMs);
+
+    Phase phase() const { return {edges, pendingEdges}; }
+    void setPhase(const Phase& phase) {
+        edges = phase.edges;
+        pendingEdges = phase.pendingEdges;
+    }
+
+private:
+    std::vector<Object*> order;
+    std::vector<Object*> clockCone; // Combinational objects between clocks and sequential objects
+    std::vector<bool> coneSlots; // By handle slot, whether the object is in clockCone
+    std::vector<Object*> sequential;
+    std::vector<Clock*> clocks;
+    std::vector<Uint64> clockDivider; // Edges of the fastest clock per edge of each clock
+    float fastestFreq = 0.0f;
+    Uint64 lastAdvanceMs = 0;
+    double pendingEdges = 0.0;
+
+    void patchOrder();
+    bool coneEdited(Uint64 since) const;
+};
+
+extern CycleSimulator cycleSimulator;
+
+#endif //CYCLESIMULATOR_HPP
@@ -5,6 +5,7 @@
 #include <SDL3/SDL.h>
 #include "Simulator.hpp"
 #include "DragAndDrop.hpp"
+#include "Camera.hpp"
 
 #include <cmath>
 #include <algorithm>
@@ -17,18 +18,23 @@ bool hit = false;
 bool clickedPin = false, clickedInputPin = false, clickedOutputPin = false;
 FakeObject* tmpFakeObject = nullptr;
 
-// Selection rectangle
+// Selection rectangle, in canvas coordinates
 bool selectionRectActive = false;
 float selectionRectStartX = 0.0f, selectionRectStartY = 0.0f;
 float selectionRectEndX = 0.0f, selectionRectEndY = 0.0f;
 
 void drawSelectionRect(SDL_Renderer* renderer) {
     if (selectionRectActive) {
-        SDL_GetMouseState(&selectionRectEndX, &selectionRectEndY);
-        const float x = std::min(selectionRectStartX, selectionRectEndX);
-        const float y = std::min(selectionRectStartY, selectionRectEndY);
-        const float w = std::abs(selectionRectEndX - selectionRectStartX);
-        const float h = std::abs(selectionRectEndY - selectionRectStartY);
+        float screenX, screenY;
+        SDL_GetMouseState(&screenX, &screenY);
+        const SDL_FPoint end = camera.toWorld(screenX, screenY);
+        selectionRectEndX = end.x;
+        selectionRectEndY = end.y;
+        const SDL_FPoint start = camera.toScreen(selectionRectStartX, selectionRectStartY);
+        const float x = std::min(start.x, screenX);
+        const float y = std::min(start.y, screenY);
+        const float w = std::abs(screenX - start.x);
+        const float h = std::abs(screenY - start.y);
 
         SDL_FRect selectionRect = {x, y, w, h};
         SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
@@ -44,9 +50,6 @@ void drawSelectionRect(SDL_Renderer* renderer) {
             };
             SDL_RenderRect(renderer, &borderRect);
         }
-
-        SDL_Log("Selection rectangle from (%f, %f) to (%f, %f)", selectionRectStartX, selectionRectStartY,
-                selectionRectEndX, selectionRectEndY);
     }
 }
 
@@ -71,32 +74,78 @@ void checkCtrlPress(const SDL_Event* event) {
     }
 }
 
+// Hit tests are sized on screen, so the canvas distances shrink as the view zooms in
+static constexpr float PIN_REACH = 20.0f; // Pixels from a pin that still grab it
+static constexpr float WIRE_REACH = 5.0f; // Pixels from a wire that still click it
+
+static bool nearPin(const float x, const float y, const ObjectView& view, const Coords& pin) {
+    const float reach = PIN_REACH / camera.zoom;
+    const float pinX = view.pos.x + pin.x * view.scale;
+    const float pinY = view.pos.y + pin.y * view.scale;
+    return x >= pinX - reach && x <= pinX + reach && y >= pinY - reach && y <= pinY + reach;
+}
+
+// Canvas area to look up objects in around the mouse, wide enough for the pins around it
+static SDL_FRect reachOf(const float x, const float y) {
+    const float reach = PIN_REACH / camera.zoom;
+    return {x - reach, y - reach, 2 * reach, 2 * reach};
+}
+
 bool isWithinObject(const auto x, const auto y, Object* obj) {
-    if (auto *wire = dynamic_cast<Wire *>(obj)) {
+    if (obj->kind == KIND_WIRE) {
+        const auto *wire = static_cast<Wire *>(obj);
         // Assume wires are only connected to one object
         auto *inputObj = wire->inputPins[0][0];
         auto *outputObj = wire->outputPins[0][0];
 
+        const ObjectView& input = inputObj->view();
+        const ObjectView& output = outputObj->view();
+
         Coords wireStart = {
-            inputObj->pos.x + inputObj->outputPinPos[wire->outputPin].x * inputObj->scale,
-            inputObj->pos.y + inputObj->outputPinPos[wire->outputPin].y * inputObj->scale
+            input.pos.x + input.outputPinPos[wire->outputPin].x * input.scale,
+            input.pos.y + input.outputPinPos[wire->outputPin].y * input.scale
         };
 
         Coords wireEnd = {
-            outputObj->pos.x + outputObj->inputPinPos[wire->inputPin].x * outputObj->scale,
-            outputObj->pos.y + outputObj->inputPinPos[wire->inputPin].y * outputObj->scale
+            output.pos.x + output.inputPinPos[wire->inputPin].x * output.scale,
+            output.pos.y + output.inputPinPos[wire->inputPin].y * output.scale
         };
 
         double dx = wireEnd.x - wireStart.x;
         double dy = wireEnd.y - wireStart.y;
 
         double cross = (x - wireStart.x) * dy - (y - wireStart.y) * dx;
-        return ((std::abs(cross) / std::sqrt(dx * dx + dy * dy) <= 5) &&
-                (std::min(wireStart.x, wireEnd.x) + 5 <= x && x <= std::max(wireStart.x, wireEnd.x) - 5) &&
-                (std::min(wireStart.y, wireEnd.y) + 5 <= y && y <= std::max(wireStart.y, wireEnd.y) - 5));
+        const double reach = WIRE_REACH / camera.zoom;
+        return ((std::abs(cross) / std::sqrt(dx * dx + dy * dy) <= reach) &&
+                (std::min(wireStart.x, wireEnd.x) + reach <= x && x <= std::max(wireStart.x, wireEnd.x) - reach) &&
+                (std::min(wireStart.y, wireEnd.y) + reach <= y && y <= std::max(wireStart.y, wireEnd.y) - reach));
+    }
+    const ObjectView& view = obj->view();
+    return x >= view.pos.x && x <= view.pos.x + view.w * view.scale &&
+        y >= view.pos.y && y <= view.pos.y + view.h * view.scale;
+}
+
+// selectedObjects holds exactly the selected objects, so clearing the selection only touches those
+static void clearSelection() {
+    for (const auto obj : selectedObjects) {
+        obj->view().selected = false;
+        obj->view().dragging = false;
+    }
+    selectedObjects.clear();
+}
+
+static void select(Object* obj) {
+    if (!obj->view().selected) {
+        obj->view().selected = true;
+        selectedObjects.push_back(obj);
+    }
+}
+
+static void deselect(Object* obj) {
+    if (obj->view().selected) {
+        obj->view().selected = false;
+        std::erase(selectedObjects, obj);
     }
-    return x >= obj->pos.x && x <= obj->pos.x + obj->w * obj->scale &&
-        y >= obj->pos.y && y <= obj->pos.y + obj->h * obj->scale;
 }
 
 /**
@@ -110,36 +159,23 @@ void handleDragAndDrop(const SDL_Event* event) {
         checkCtrlPress(event);
         break;
     case SDL_EVENT_MOUSE_BUTTON_DOWN: {
-        float mouseX, mouseY;
-        SDL_GetMouseState(&mouseX, &mouseY);
+        float screenX, screenY;
+        SDL_GetMouseState(&screenX, &screenY);
+        const auto [mouseX, mouseY] = camera.toWorld(screenX, screenY);
         clickTime = SDL_GetTicks();
-        SDL_Log("\n\n\n\n\n\nMouse down at (%f, %f)", mouseX, mouseY);
         hit = false;
 
-        std::vector<Object*> objectsCopy = objects;
-
-        for (auto it = objectsCopy.rbegin(); it != objectsCopy.rend(); ++it) {
-            Object* obj = *it;
-
-            if (std::find(objects.begin(), objects.end(), obj) == objects.end()) {
-                continue;
-            }
-
-            if (obj == nullptr) continue;
-            // Bounds checking
-            SDL_Log("Object size (%f, %f)", obj->w, obj->h);
+        // Only the objects near the mouse, topmost first. Grabbing a pin adds a wire, which the
+        // result doesn't include.
+        for (Object* obj : spatialIndex.query(reachOf(mouseX, mouseY))) {
+            const ObjectView& view = obj->view();
             // Check for pins
             // This assumes that the object is not rotated.
 
             // Output pins
             if (!clickedPin) {
-                for (int pin = 0; pin < obj->outputPinPos.size(); ++pin) {
-                    SDL_Log("Checking pin at (%f, %f)", obj->outputPinPos[pin].x, obj->outputPinPos[pin].y);
-                    if (mouseX >= obj->pos.x + (obj->outputPinPos[pin].x * obj->scale) - 20 &&
-                        mouseX <= obj->pos.x + (obj->outputPinPos[pin].x * obj->scale) + 20 &&
-                        mouseY >= obj->pos.y + (obj->outputPinPos[pin].y * obj->scale) - 20 &&
-                        mouseY <= obj->pos.y + (obj->outputPinPos[pin].y * obj->scale) + 20) {
-                        SDL_Log("Grabbed output pin\n\n");
+                for (int pin = 0; pin < view.outputPinPos.size(); ++pin) {
+                    if (nearPin(mouseX, mouseY, view, view.outputPinPos[pin])) {
                         clickedOutputPin = true;
                         const auto tmpWire = new Wire(nullptr);
                         const auto tmpObj = new FakeObject(nullptr);
@@ -147,7 +183,7 @@ void handleDragAndDrop(const SDL_Event* event) {
                         Object::connect(obj, tmpWire, pin, 0);
                         Object::connect(tmpWire, tmpObj, 0, 0);
                         selectedObjects.push_back(tmpObj);
-                        tmpObj->dragging = true;
+                        tmpObj->view().dragging = true;
                         clickedObject = tmpWire; // The wire is not actually clicked, but we need to keep track of it
                         break;
                     }
@@ -156,13 +192,8 @@ void handleDragAndDrop(const SDL_Event* event) {
 
             // Input pins
             if (!clickedPin) {
-                for (int pin = 0; pin < obj->inputPinPos.size(); ++pin) {
-                    SDL_Log("Checking pin at (%f, %f)", obj->inputPinPos[pin].x, obj->inputPinPos[pin].y);
-                    if (mouseX >= obj->pos.x + (obj->inputPinPos[pin].x * obj->scale) - 20 &&
-                        mouseX <= obj->pos.x + (obj->inputPinPos[pin].x * obj->scale) + 20 &&
-                        mouseY >= obj->pos.y + (obj->inputPinPos[pin].y * obj->scale) - 20 &&
-                        mouseY <= obj->pos.y + (obj->inputPinPos[pin].y * obj->scale) + 20) {
-                        SDL_Log("Grabbed input pin\n\n");
+                for (int pin = 0; pin < view.inputPinPos.size(); ++pin) {
+                    if (nearPin(mouseX, mouseY, view, view.inputPinPos[pin])) {
                         clickedInputPin = true;
                         const auto tmpWire = new Wire(nullptr);
                         const auto tmpObj = new FakeObject(nullptr);
@@ -170,7 +201,7 @@ void handleDragAndDrop(const SDL_Event* event) {
                         Object::connect(tmpWire, obj, 0, pin);
                         Object::connect(tmpObj, tmpWire, 0, 0);
                         selectedObjects.push_back(tmpObj);
-                        tmpObj->dragging = true;
+                        tmpObj->view().dragging = true;
                         clickedObject = tmpWire; // The wire is not actually clicked, but we need to keep track of it
                         break;
                     }
@@ -182,43 +213,26 @@ void handleDragAndDrop(const SDL_Event* event) {
             if (!clickedPin && isWithinObject(mouseX, mouseY, obj)) {
                 hit = true;
                 clickedObject = obj;
-                if (!ctrlPressed) {
-                    clickedObjectPrevState = clickedObject->selected;
-                    if (!clickedObject->selected) {
-                        for (const auto _obj : objects) {
-                            _obj->selected = false;
-                            _obj->dragging = false;
-                        }
-                        clickedObject->selected = true;
-                    }
-                    clickedObject->selected = true;
-                }
-                else {
-                    clickedObjectPrevState = clickedObject->selected;
-                    clickedObject->selected = true;
+                clickedObjectPrevState = clickedObject->view().selected;
+                if (!ctrlPressed && !clickedObjectPrevState) {
+                    clearSelection();
                 }
+                select(clickedObject);
 
                 // Drag
-                selectedObjects.clear();
-                for (auto _obj : objects) {
-                    if (_obj->selected) {
-                        selectedObjects.push_back(_obj);
-                        _obj->dragging = true;
-                        _obj->offsetX = mouseX - _obj->pos.x;
-                        _obj->offsetY = mouseY - _obj->pos.y;
-                    }
+                for (const auto _obj : selectedObjects) {
+                    ObjectView& _view = _obj->view();
+                    _view.dragging = true;
+                    _view.offsetX = mouseX - _view.pos.x;
+                    _view.offsetY = mouseY - _view.pos.y;
                 }
                 break;
             }
         }
         if (!clickedPin && !hit && !ctrlPressed) {
-            for (const auto obj : objects) {
-                obj->selected = false;
-            }
-            selectedObjects.clear();
+            clearSelection();
         }
         if (!hit && !clickedPin && event->button.button == SDL_BUTTON_LEFT) {
-            SDL_Log("Start selection rectangle at (%f, %f)", mouseX, mouseY);
             selectionRectStartX = mouseX;
             selectionRectStartY = mouseY;
             selectionRectActive = true;
@@ -229,72 +243,54 @@ void handleDragAndDrop(const SDL_Event* event) {
     }
     case SDL_EVENT_MOUSE_MOTION:
         if (!selectionRectActive) {
+            const SDL_FPoint mouse = camera.toWorld(event->motion.x, event->motion.y);
             for (const auto obj : selectedObjects) {
-                if (obj->dragging) {
-                    obj->pos.x = event->motion.x - obj->offsetX;
-                    obj->pos.y = event->motion.y - obj->offsetY;
+                const ObjectView& view = obj->view();
+                if (view.dragging) {
+                    obj->moveTo(mouse.x - view.offsetX, mouse.y - view.offsetY);
                 }
             }
         }
         break;
     case SDL_EVENT_MOUSE_BUTTON_UP:
         if (selectionRectActive && event->button.button == SDL_BUTTON_LEFT) {
-            SDL_Log("Stop selection rectangle");
-
             // Select objects within the rectangle
             const float minX = std::min(selectionRectStartX, selectionRectEndX);
             const float maxX = std::max(selectionRectStartX, selectionRectEndX);
             const float minY = std::min(selectionRectStartY, selectionRectEndY);
             const float maxY = std::max(selectionRectStartY, selectionRectEndY);
 
-            for (auto obj : objects) {
-                SDL_Log("Object at (%f, %f) with scale %f", obj->pos.x, obj->pos.y, obj->scale);
+            for (auto obj : spatialIndex.query({minX, minY, maxX - minX, maxY - minY})) {
+                const ObjectView& view = obj->view();
                 // Bounds checking
-                if (obj->pos.x >= minX && obj->pos.x + obj->w * obj->scale <= maxX &&
-                    obj->pos.y >= minY && obj->pos.y + obj->h * obj->scale <= maxY) {
-                    SDL_Log("Selected object");
-                    obj->selected = true;
-                    selectedObjects.push_back(obj);
+                if (view.pos.x >= minX && view.pos.x + view.w * view.scale <= maxX &&
+                    view.pos.y >= minY && view.pos.y + view.h * view.scale <= maxY) {
+                    select(obj);
                 }
             }
         }
 
         if (clickedPin) {
-            SDL_Log("Pin was clicked, checking for snapping.");
+            // The loose end was only in the selection to be dragged
+            std::erase(selectedObjects, static_cast<Object*>(tmpFakeObject));
             bool snapped = false;
-            float mouseX, mouseY;
-            SDL_GetMouseState(&mouseX, &mouseY);
-            // If possible, snap to pin
-            for (auto it = objects.rbegin(); it != objects.rend(); ++it) {
-                Object* obj = *it;
-                if (obj == nullptr) continue;
-
-                // Skip FakeObjects
-                if (dynamic_cast<FakeObject*>(obj)) continue;
-
-                // Bounds checking
-                SDL_Log("Object size (%f, %f)", obj->w, obj->h);
+            float screenX, screenY;
+            SDL_GetMouseState(&screenX, &screenY);
+            const auto [mouseX, mouseY] = camera.toWorld(screenX, screenY);
+            // If possible, snap to pin. The index leaves out the loose end being dragged.
+            for (Object* obj : spatialIndex.query(reachOf(mouseX, mouseY))) {
+                const ObjectView& view = obj->view();
                 // Check for pins
                 // This assumes that the object is not rotated.
 
                 if (clickedOutputPin) {
-                    for (int pin = 0; pin < obj->inputPinPos.size(); ++pin) {
-                        SDL_Log("Checking pin at (%f, %f)", obj->inputPinPos[pin].x, obj->inputPinPos[pin].y);
-
-
-                        if (mouseX >= obj->pos.x + (obj->inputPinPos[pin].x * obj->scale) - 20 &&
-                            mouseX <= obj->pos.x + (obj->inputPinPos[pin].x * obj->scale) + 20 &&
-                            mouseY >= obj->pos.y + (obj->inputPinPos[pin].y * obj->scale) - 20 &&
-                            mouseY <= obj->pos.y + (obj->inputPinPos[pin].y * obj->scale) + 20) {
-                            SDL_Log("Snapped to pin\n\n");
-
+                    for (int pin = 0; pin < view.inputPinPos.size(); ++pin) {
+                        if (nearPin(mouseX, mouseY, view, view.inputPinPos[pin])) {
                             // Check if the user is trying to connect to the same object
                             // clickedObject is the wire, so the actual object is the first input pin
                             if (std::ranges::find(clickedObject->inputPins[0], obj) != clickedObject->inputPins[0].end()) {
-                                SDL_Log("Clicked object is the same as the object being snapped to, not creating a new connection.");
                                 clickedPin = false;
                                 clickedOutputPin = false;
-                                selectedObjects.clear();
                                 break;
                             }
 
@@ -307,28 +303,17 @@ void handleDragAndDrop(const SDL_Event* event) {
 
                             clickedPin = false;
                             clickedOutputPin = false;
-                            selectedObjects.clear();
                             snapped = true;
                         }
                     }
                 } else if (clickedInputPin) {
-                    for (int pin = 0; pin < obj->outputPinPos.size(); ++pin) {
-                        SDL_Log("Checking pin at (%f, %f)", obj->outputPinPos[pin].x, obj->outputPinPos[pin].y);
-
-
-                        if (mouseX >= obj->pos.x + (obj->outputPinPos[pin].x * obj->scale) - 20 &&
-                            mouseX <= obj->pos.x + (obj->outputPinPos[pin].x * obj->scale) + 20 &&
-                            mouseY >= obj->pos.y + (obj->outputPinPos[pin].y * obj->scale) - 20 &&
-                            mouseY <= obj->pos.y + (obj->outputPinPos[pin].y * obj->scale) + 20) {
-                            SDL_Log("Snapped to pin\n\n");
-
+                    for (int pin = 0; pin < view.outputPinPos.size(); ++pin) {
+                        if (nearPin(mouseX, mouseY, view, view.outputPinPos[pin])) {
                             // Check if the user is trying to connect to the same object
                             // clickedObject is the wire, so the actual object is the first input pin
                             if (std::ranges::find(clickedObject->outputPins[0], obj) != clickedObject->outputPins[0].end()) {
-                                SDL_Log("Clicked object is the same as the object being snapped to, not creating a new connection.");
                                 clickedPin = false;
                                 clickedInputPin = false;
-                                selectedObjects.clear();
                                 break;
                             }
 
@@ -341,7 +326,6 @@ void handleDragAndDrop(const SDL_Event* event) {
 
                             clickedPin = false;
                             clickedInputPin = false;
-                            selectedObjects.clear();
                             snapped = true;
                             }
                     }
@@ -349,68 +333,45 @@ void handleDragAndDrop(const SDL_Event* event) {
             }
 
             if (!snapped) {
-                SDL_Log("Didn't snap to any pin.");
                 if (clickedOutputPin) {
-                    SDL_Log("Had clicked output pin.");
-                    // We assume that the wire's input and output pins are only connected to one object
-                    for (auto &outputPins : clickedObject->inputPins[0][0]->outputPins) {
-                        std::erase(outputPins, clickedObject);
-                    }
-                    Object *tmpObj = clickedObject->outputPins[0][0];
+                    // Deleting the wire and its loose end disconnects them from the pin they were dragged from
                     delete clickedObject->outputPins[0][0];
-                    std::erase(clickedObject->outputPins[0], tmpObj);
                     delete clickedObject;
                     clickedObject = nullptr;
+                    tmpFakeObject = nullptr;
                 } else if (clickedInputPin) {
-                    SDL_Log("Had clicked input pin.");
-                    // We assume that the wire's input and output pins are only connected to one object
-                    for (auto &inputPins : clickedObject->outputPins[0][0]->inputPins) {
-                        std::erase(inputPins, clickedObject);
-                    }
-                    Object *tmpObj = clickedObject->inputPins[0][0];
+                    // Deleting the wire and its loose end disconnects them from the pin they were dragged from
                     delete clickedObject->inputPins[0][0];
-                    std::erase(clickedObject->inputPins[0], tmpObj);
                     delete clickedObject;
                     clickedObject = nullptr;
+                    tmpFakeObject = nullptr;
                 }
             }
         }
 
-        SDL_Log("Mouse up.");
         if (hit && clickedObject) {
-            SDL_Log("Hit and clicked object.");
             if (SDL_GetTicks() - clickTime < 150) { // Short click
-                SDL_Log("Short click detected.");
                 if (!ctrlPressed) { // Ctrl is not pressed
-                    SDL_Log("Ctrl was not pressed.");
                     if (selectedObjects.size() == 1) { // Only one object is selected
-                        SDL_Log("Only one object is selected.");
-                        if (auto* btn = dynamic_cast<Button*>(clickedObject)) {
-                            SDL_Log("Clicked on a button.");
-                            btn->state = !btn->state;
-                            eventQueue.push(clickedObject);
-                            clickedObject->queued = true;
-                            btn->selected = false;
+                        if (clickedObject->kind == KIND_BUTTON) {
+                            auto* btn = static_cast<Button*>(clickedObject);
+                            btn->press();
+                            deselect(btn);
                         }
-                        else {
-                            clickedObject->selected = !clickedObjectPrevState;
+                        else if (clickedObjectPrevState) {
+                            deselect(clickedObject);
                         }
                     }
                     else {
-                        SDL_Log("Multiple objects are selected.");
-                        for (const auto obj : selectedObjects) {
-                            obj->selected = false;
-                        }
-                        clickedObject->selected = true;
+                        clearSelection();
+                        select(clickedObject);
                     }
                 }
-                else { // Ctrl is pressed
-                    SDL_Log("Ctrl was pressed.");
-                    clickedObject->selected = !clickedObjectPrevState;
+                else if (clickedObjectPrevState) { // Ctrl is pressed
+                    deselect(clickedObject);
                 }
             }
             else { // Long click
-                SDL_Log("Long click detected.");
                 if (!ctrlPressed) { // Ctrl is not pressed
                     // Keep the selected objects selected
                 }
@@ -419,16 +380,14 @@ void handleDragAndDrop(const SDL_Event* event) {
                 }
             }
 
-            // Stop dragging
+            // Stop dragging, including an object that was just deselected
+            clickedObject->view().dragging = false;
             for (const auto obj : selectedObjects) {
-                obj->dragging = false;
+                obj->view().dragging = false;
             }
         }
         else if ((!hit && !ctrlPressed) && !selectionRectActive) {
-            for (const auto obj : objects) {
-                obj->selected = false;
-                obj->dragging = false;
-            }
+            clearSelection();
         }
         else if (selectionRectActive) {
             selectionRectActive = false;
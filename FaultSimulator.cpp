@@ -0,0 +1,157 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "FaultSimulator.hpp"
+#include "Logic.hpp"
+
+#include <algorithm>
+
+FaultSimulator::FaultSimulator(const CombinationalModel& model) : model(model) {
+    for (Uint32 c = 0; c < model.cells.size(); ++c) {
+        const auto& cell = model.cells[c];
+        if (!cell.gate) continue;
+        for (Sint32 pin = -1; pin < cell.pins; ++pin) {
+            faults.push_back({c, pin, false});
+            faults.push_back({c, pin, true});
+        }
+    }
+    detected.assign(faults.size(), false);
+    remaining.resize(faults.size());
+    for (Uint32 i = 0; i < faults.size(); ++i) remaining[i] = i;
+
+    values.assign(model.signalCount, 0);
+    const size_t pins = model.pinSourceStart.empty() ? 0 : model.pinSourceStart.size() - 1;
+    pinForce0.assign(pins, 0);
+    pinForce1.assign(pins, 0);
+    cellForce0.assign(model.cells.size(), 0);
+    cellForce1.assign(model.cells.size(), 0);
+}
+
+void FaultSimulator::reset() {
+    detected.assign(faults.size(), false);
+    detectedFaults = 0;
+    remaining.resize(faults.size());
+    for (Uint32 i = 0; i < faults.size(); ++i) remaining[i] = i;
+}
+
+void FaultSimulator::inject(const Fault& fault, const Uint64 bit) {
+    const auto& cell = model.cells[fault.cell];
+    if (fault.pin < 0) {
+        (fault.stuckAt ? cellForce1 : cellForce0)[fault.cell] |= bit;
+    } else {
+        (fault.stuckAt ? pinForce1 : pinForce0)[cell.pinStart + fault.pin] |= bit;
+    }
+}
+
+void FaultSimulator::clear(const Fault& fault) {
+    const auto& cell = model.cells[fault.cell];
+    if (fault.pin < 0) {
+        cellForce0[fault.cell] = cellForce1[fault.cell] = 0;
+    } else {
+        pinForce0[cell.pinStart + fault.pin] = pinForce1[cell.pinStart + fault.pin] = 0;
+    }
+}
+
+Uint64 FaultSimulator::evalPin(const Uint32 pin) const {
+    Uint64 value = 0;
+    for (Uint32 s = model.pinSourceStart[pin]; s < model.pinSourceStart[pin + 1]; ++s) {
+        value |= values[model.pinSources[s]];
+    }
+    return value;
+}
+
+// Evaluates all cells and returns the machines that differ from bit 0 at any output
+Uint64 FaultSimulator::evaluate() {
+    for (Uint32 c = 0; c < model.cells.size(); ++c) {
+        const auto& cell = model.cells[c];
+        Uint64 in[2] = {0, 0};
+        for (Uint32 k = 0; k < cell.pins; ++k) {
+            const Uint32 pin = cell.pinStart + k;
+            in[k] = (evalPin(pin) & ~pinForce0[pin]) | pinForce1[pin];
+        }
+        const Uint64 out = gateFunction(cell.type, in[0], in[1]);
+        values[cell.signal] = (out & ~cellForce0[c]) | cellForce1[c];
+    }
+
+    Uint64 differs = 0;
+    for (const Uint32 pin : model.outputs) {
+        const Uint64 value = evalPin(pin);
+        differs |= value ^ (0 - (value & 1));
+    }
+    return differs;
+}
+
+size_t FaultSimulator::simulate(const Pattern& pattern) {
+    if (pattern.size() != model.inputs.size()) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Pattern has %zu values, the circuit has %zu inputs.",
+            pattern.size(), model.inputs.size());
+        return 0;
+    }
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        values[model.inputs[i]] = pattern[i] ? ~Uint64{0} : 0;
+    }
+
+    size_t found = 0;
+    for (size_t start = 0; start < remaining.size(); start += FAULTS_PER_PASS) {
+        const size_t end = std::min(remaining.size(), start + FAULTS_PER_PASS);
+        for (size_t i = start; i < end; ++i) inject(faults[remaining[i]], Uint64{2} << (i - start));
+
+        const Uint64 differs = evaluate();
+
+        for (size_t i = start; i < end; ++i) {
+            clear(faults[remaining[i]]);
+            if (differs & (Uint64{2} << (i - start))) {
+                detected[remaining[i]] = true;
+                found++;
+            }
+        }
+    }
+
+    // Fault dropping
+    if (found > 0) {
+        std::erase_if(remaining, [this](const Uint32 f) { return detected[f]; });
+        detectedFaults += found;
+    }
+    return found;
+}
+
+size_t FaultSimulator::simulate(const std::vector<Pattern>& patterns) {
+    size_t found = 0;
+    for (const auto& pattern : patterns) {
+        if (remaining.empty()) break;
+        found += simulate(pattern);
+    }
+    return found;
+}
+
+double FaultSimulator::coverage() const {
+    return faults.empty() ? 100.0 : 100.0 * static_cast<double>(detectedFaults) / static_cast<double>(faults.size());
+}
+
+std::string FaultSimulator::describe(const Fault& fault) const {
+    const auto& cell = model.cells[fault.cell];
+    std::string name = objectName(model.nodes[cell.node]);
+    name += fault.pin < 0 ? " output" : " input " + std::to_string(fault.pin);
+    name += fault.stuckAt ? " stuck-at-1" : " stuck-at-0";
+    return name;
+}
+
+bool FaultSimulator::writeReport(const char* path) const {
+    SDL_Log("Fault coverage: %zu of %zu stuck-at faults detected (%.2f%%).", detectedFaults, faults.size(), coverage());
+
+    SDL_IOStream* file = SDL_IOFromFile(path, "w");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create %s: %s", path, SDL_GetError());
+        return false;
+    }
+    SDL_IOprintf(file, "faults %zu\ndetected %zu\ncoverage %.2f%%\n\nundetected:\n",
+        faults.size(), detectedFaults, coverage());
+    for (const Uint32 f : remaining) {
+        SDL_IOprintf(file, "%s\n", describe(faults[f]).c_str());
+    }
+    SDL_CloseIO(file);
+    SDL_Log("Wrote %zu undetected faults to %s.", remaining.size(), path);
+    return true;
+}
@@ -0,0 +1,65 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef FAULTSIMULATOR_HPP
+#define FAULTSIMULATOR_HPP
+
+#include <SDL3/SDL.h>
+#include <string>
+#include <vector>
+
+#include "CombinationalModel.hpp"
+
+// A single stuck-at fault on a gate pin
+struct Fault {
+    Uint32 cell; // Index into CombinationalModel::cells
+    Sint32 pin; // Input pin of the cell, or -1 for its output
+    bool stuckAt;
+};
+
+// Parallel-fault simulator for single stuck-at faults. Every 64-bit word carries the fault-free
+// machine in bit 0 and up to 63 faulty machines in the other bits, so one pass over the model
+// grades 63 faults against a pattern. Detected faults are dropped from later passes.
+class FaultSimulator {
+public:
+    static constexpr int FAULTS_PER_PASS = 63;
+
+    std::vector<Fault> faults; // Both polarities on every input and output of every gate
+    std::vector<bool> detected; // Parallel to faults
+
+    explicit FaultSimulator(const CombinationalModel& model);
+
+    /**
+     * @brief Simulates one pattern against all faults that are still undetected.
+     * @return The number of faults the pattern detected for the first time.
+     */
+    size_t simulate(const Pattern& pattern);
+    size_t simulate(const std::vector<Pattern>& patterns);
+    // Clears the detected flags, so the fault list can be graded again
+    void reset();
+
+    size_t detectedCount() const { return detectedFaults; }
+    double coverage() const;
+    std::string describe(const Fault& fault) const;
+
+    // Logs the coverage and writes it, along with the undetected faults, to a text file
+    bool writeReport(const char* path) const;
+
+private:
+    const CombinationalModel& model;
+    size_t detectedFaults = 0;
+    std::vector<Uint32> remaining; // Undetected faults
+
+    std::vector<Uint64> values; // Per signal
+    // Bits forced to 0 and to 1, per model pin and per cell output
+    std::vector<Uint64> pinForce0, pinForce1;
+    std::vector<Uint64> cellForce0, cellForce1;
+
+    void inject(const Fault& fault, Uint64 bit);
+    void clear(const Fault& fault);
+    Uint64 evalPin(Uint32 pin) const;
+    Uint64 evaluate();
+};
+
+#endif //FAULTSIMULATOR_HPP
@@ -0,0 +1,328 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Journal.hpp"
+#include "Checkpoint.hpp"
+
+#include <algorithm>
+
+// Writes value as a varint to out, which must have room for 10 bytes. Returns the end of the written bytes.
+static Uint8* putVarint(Uint8* out, Uint64 value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<Uint8>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<Uint8>(value);
+    return out;
+}
+
+static Uint64 getVarint(const Uint8*& in) {
+    Uint64 value = 0;
+    int shift = 0;
+    while (*in & 0x80) {
+        value |= static_cast<Uint64>(*in++ & 0x7f) << shift;
+        shift += 7;
+    }
+    value |= static_cast<Uint64>(*in++) << shift;
+    return value;
+}
+
+size_t Journal::Segment::bytes() const {
+    return checkpoint.size() + records.size() + recordOffsets.size() * sizeof(Uint32) +
+           recordTimes.size() * sizeof(Uint64);
+}
+
+Journal::Journal(const size_t memoryBudget, const size_t checkpointSpacing) :
+    memoryBudget(memoryBudget), checkpointSpacing(checkpointSpacing) {
+    // Changes go straight into the buffer, flush() encodes them a batch at a time
+    changedSlots = &toggles;
+}
+
+void Journal::onChange(const Object* obj) {
+    toggles.push_back(obj->handle.slot);
+}
+
+void Journal::onMemoryWrite(const Object* obj, const Uint32 address, const Uint8 oldValue, const Uint8 newValue) {
+    writes.push_back({obj->handle.slot, address, static_cast<Uint8>(oldValue ^ newValue)});
+}
+
+void Journal::onTimeAdvance() {
+    // History of a circuit that has since been edited can't be restored, and history that a
+    // restored checkpoint took back in time can't be ordered with what follows
+    if (version != netlistVersion || simTime <= currentTime) {
+        clear();
+        version = netlistVersion;
+    }
+    if (rewound) truncateFuture();
+
+    endRecord();
+    currentTime = simTime;
+    // Between two delta cycles the queue holds exactly the next one, so this is a consistent point
+    if (segments.empty() || segmentFull()) {
+        flush();
+        startSegment();
+    } else if (toggles.size() + writes.size() >= BATCH_CHANGES) {
+        flush();
+    }
+}
+
+// Whether the records of the last segment have grown large enough to pay for a new checkpoint
+bool Journal::segmentFull() const {
+    const Segment& segment = segments.back();
+    const size_t recorded = segment.bytes() - segment.checkpoint.size();
+    return recorded >= std::max(MIN_SEGMENT_BYTES, segment.checkpoint.size() * checkpointSpacing);
+}
+
+// Closes the record of the delta cycle in progress, unless nothing changed in it
+void Journal::endRecord() {
+    const auto toggleCount = static_cast<Uint32>(toggles.size());
+    const auto writeCount = static_cast<Uint32>(writes.size());
+    const bool empty = ends.empty() ? toggleCount == 0 && writeCount == 0
+                                    : ends.back().toggles == toggleCount && ends.back().writes == writeCount;
+    if (!empty) ends.push_back({toggleCount, writeCount, currentTime});
+}
+
+// Encodes the pending records, one per delta cycle: toggle count, write count, handle slot deltas
+// (zigzag varints), then (slot, address, old ^ new) writes. The history is dropped on every edit,
+// so a slot names the same object for as long as it is kept.
+void Journal::flush() {
+    endRecord();
+    if (ends.empty()) return;
+    if (segments.empty() || version != netlistVersion) {
+        // Changes from before the first checkpoint have nothing to be replayed on
+        toggles.clear();
+        writes.clear();
+        ends.clear();
+        return;
+    }
+    // Changes made in a past state replace the future that was recorded from it
+    if (rewound) truncateFuture();
+
+    Segment& segment = segments.back();
+    const size_t before = segment.bytes();
+
+    // Encode into a scratch buffer sized for the worst case, so no capacity checks per byte
+    constexpr size_t MAX_VARINT = 10;
+    const size_t worstCase = (2 * ends.size() + toggles.size() + writes.size() * 3) * MAX_VARINT;
+    if (scratch.size() < worstCase) scratch.resize(worstCase);
+    Uint8* out = scratch.data();
+
+    // Plain pointers, as the compiler must assume that writes through out may change the vectors
+    const Uint32* toggle = toggles.data();
+    const MemoryWrite* write = writes.data();
+    const size_t firstRecord = segment.recordOffsets.size();
+    segment.recordOffsets.resize(firstRecord + ends.size());
+    segment.recordTimes.resize(firstRecord + ends.size());
+    Uint32* offset = segment.recordOffsets.data() + firstRecord;
+    Uint64* time = segment.recordTimes.data() + firstRecord;
+    const Uint8* base = scratch.data() - segment.records.size();
+    for (const RecordEnd& end : ends) {
+        const Uint32* togglesEnd = toggles.data() + end.toggles;
+        const MemoryWrite* writesEnd = writes.data() + end.writes;
+        *offset++ = static_cast<Uint32>(out - base);
+        *time++ = end.time;
+        out = putVarint(out, togglesEnd - toggle);
+        out = putVarint(out, writesEnd - write);
+        Sint64 prev = 0;
+        for (; toggle < togglesEnd; ++toggle) {
+            const Sint64 delta = static_cast<Sint64>(*toggle) - prev;
+            const auto zigzag = static_cast<Uint64>(delta << 1 ^ delta >> 63);
+            // Nearby objects are usually created, and so evaluated, close together
+            if (zigzag < 0x80) *out++ = static_cast<Uint8>(zigzag);
+            else out = putVarint(out, zigzag);
+            prev = *toggle;
+        }
+        for (; write < writesEnd; ++write) {
+            out = putVarint(out, write->slot);
+            out = putVarint(out, write->address);
+            *out++ = write->delta;
+        }
+    }
+    segment.records.insert(segment.records.end(), scratch.data(), out);
+
+    used += segment.bytes() - before;
+    cursorSegment = segments.size() - 1;
+    cursorRecord = segment.recordOffsets.size();
+    toggles.clear();
+    writes.clear();
+    ends.clear();
+    enforceBudget();
+}
+
+void Journal::startSegment() {
+    // Take over the buffers of the last dropped segment, with room for as many records as the
+    // previous one, so recording doesn't grow and copy them every few records
+    Segment segment;
+    std::swap(segment, spare);
+    segment.records.clear();
+    segment.recordOffsets.clear();
+    segment.recordTimes.clear();
+    if (!segments.empty()) {
+        const Segment& previous = segments.back();
+        segment.records.reserve(previous.records.size());
+        segment.recordOffsets.reserve(previous.recordOffsets.size());
+        segment.recordTimes.reserve(previous.recordTimes.size());
+    }
+    segment.startTime = simTime;
+    segment.checkpoint = saveCheckpoint();
+    used += segment.bytes();
+    segments.push_back(std::move(segment));
+    cursorSegment = segments.size() - 1;
+    cursorRecord = 0;
+    enforceBudget();
+}
+
+void Journal::truncateFuture() {
+    rewound = false;
+    while (segments.size() > cursorSegment + 1) {
+        used -= segments.back().bytes();
+        segments.pop_back();
+    }
+
+    Segment& segment = segments[cursorSegment];
+    if (cursorRecord < segment.recordOffsets.size()) {
+        used -= segment.bytes();
+        segment.records.resize(segment.recordOffsets[cursorRecord]);
+        segment.recordOffsets.resize(cursorRecord);
+        segment.recordTimes.resize(cursorRecord);
+        used += segment.bytes();
+    }
+}
+
+void Journal::enforceBudget() {
+    while (used > memoryBudget && segments.size() > 1 && cursorSegment > 0) {
+        used -= segments.front().bytes();
+        spare = std::move(segments.front());
+        segments.pop_front();
+        cursorSegment--;
+    }
+}
+
+// Records are XOR deltas, so applying one both undoes and redoes it
+void Journal::apply(const Segment& segment, const size_t record) {
+    const Uint8* in = segment.records.data() + segment.recordOffsets[record];
+    const Uint64 toggleCount = getVarint(in);
+    const Uint64 writeCount = getVarint(in);
+
+    Sint64 slot = 0;
+    for (Uint64 i = 0; i < toggleCount; ++i) {
+        const Uint64 zigzag = getVarint(in);
+        slot += static_cast<Sint64>(zigzag >> 1) ^ -static_cast<Sint64>(zigzag & 1);
+        Object* obj = objectSlots.at(static_cast<Uint32>(slot));
+        obj->state() = !obj->state();
+        notifyChange(obj);
+    }
+    for (Uint64 i = 0; i < writeCount; ++i) {
+        Object* obj = objectSlots.at(static_cast<Uint32>(getVarint(in)));
+        const auto address = static_cast<Uint32>(getVarint(in));
+        const Uint8 delta = *in++;
+        if (obj->kind == KIND_RAM) {
+            Uint8& word = static_cast<Ram*>(obj)->memory[address];
+            notifyMemoryWrite(obj, address, word, word ^ delta);
+            word ^= delta;
+        }
+    }
+}
+
+// The rewound state is a settled snapshot: drop pending events and rederive internal state. The
+// changes were reported to the other listeners; the journal already has them.
+void Journal::finishNavigation() {
+    rewound = isRewound();
+    currentTime = simTime;
+    toggles.clear();
+    writes.clear();
+    ends.clear();
+    eventQueue = {};
+    sequentialQueue.clear();
+    deltaRemaining = 0;
+    for (auto* obj : objects) {
+        obj->queued() = false;
+        obj->resync();
+    }
+}
+
+bool Journal::isRewound() const {
+    return !segments.empty() &&
+           (cursorSegment != segments.size() - 1 || cursorRecord != segments.back().recordOffsets.size());
+}
+
+Uint64 Journal::earliestTime() const {
+    return segments.empty() ? simTime : segments.front().startTime;
+}
+
+bool Journal::stepBack() {
+    flush();
+    if (segments.empty() || version != netlistVersion) return false;
+
+    while (cursorRecord == 0) {
+        if (cursorSegment == 0) return false;
+        cursorSegment--;
+        cursorRecord = segments[cursorSegment].recordOffsets.size();
+    }
+
+    const Segment& segment = segments[cursorSegment];
+    cursorRecord--;
+    apply(segment, cursorRecord);
+    simTime = segment.recordTimes[cursorRecord];
+    finishNavigation();
+    return true;
+}
+
+bool Journal::stepForward() {
+    flush();
+    if (!isRewound() || version != netlistVersion) return false;
+
+    while (cursorRecord == segments[cursorSegment].recordOffsets.size()) {
+        if (cursorSegment + 1 == segments.size()) return false;
+        cursorSegment++;
+        cursorRecord = 0;
+    }
+
+    const Segment& segment = segments[cursorSegment];
+    apply(segment, cursorRecord);
+    simTime = segment.recordTimes[cursorRecord] + 1;
+    cursorRecord++;
+    finishNavigation();
+    return true;
+}
+
+/**
+ * @brief Rewinds the simulation to the state it had right before the given time.
+ * @param time Virtual time to jump to. Times before the start of the history go to the earliest state kept.
+ * @return false if there is no usable history.
+ */
+bool Journal::jumpTo(const Uint64 time) {
+    flush();
+    if (segments.empty() || version != netlistVersion) return false;
+
+    size_t target = 0;
+    while (target + 1 < segments.size() && segments[target + 1].startTime <= time) {
+        target++;
+    }
+
+    const Segment& segment = segments[target];
+    if (!restoreCheckpoint(segment.checkpoint.data(), segment.checkpoint.size())) return false;
+
+    cursorSegment = target;
+    cursorRecord = 0;
+    while (cursorRecord < segment.recordOffsets.size() && segment.recordTimes[cursorRecord] < time) {
+        apply(segment, cursorRecord);
+        cursorRecord++;
+    }
+    simTime = std::max(time, segment.startTime);
+    finishNavigation();
+    return true;
+}
+
+void Journal::clear() {
+    segments.clear();
+    rewound = false;
+    cursorSegment = 0;
+    cursorRecord = 0;
+    used = 0;
+    toggles.clear();
+    writes.clear();
+    ends.clear();
+}
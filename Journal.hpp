@@ -0,0 +1,93 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <SDL3/SDL.h>
+#include <deque>
+#include <vector>
+
+#include "Simulator.hpp"
+
+// Records the history of the simulation so it can be stepped backwards. For every delta cycle
+// the journal stores which objects changed state and which memory words were written, delta-
+// and varint-encoded. Once the changes recorded since the last full checkpoint take
+// checkpointSpacing times its size, it takes another. A checkpoint copies every state and all
+// RAM contents, so its cost is spread over at least as many bytes of recorded changes, and
+// jumping to any earlier time restores one checkpoint and replays at most that many bytes.
+// The oldest history is dropped once the journal exceeds its memory budget.
+class Journal final : public ChangeListener {
+public:
+    explicit Journal(size_t memoryBudget = 64 * 1024 * 1024, size_t checkpointSpacing = 1);
+
+    void onChange(const Object* obj) override;
+    void onMemoryWrite(const Object* obj, Uint32 address, Uint8 oldValue, Uint8 newValue) override;
+    void onTimeAdvance() override;
+
+    bool stepBack();
+    bool stepForward();
+    bool jumpTo(Uint64 time);
+    void clear();
+
+    // True while the journal shows a past state; recording the next change discards the future.
+    bool isRewound() const;
+    Uint64 earliestTime() const;
+    size_t bytesUsed() const { return used; }
+
+    size_t memoryBudget;
+    size_t checkpointSpacing; // Bytes of recorded changes per byte of checkpoint
+
+private:
+    struct MemoryWrite {
+        Uint32 slot; // Of the RAM's handle
+        Uint32 address;
+        Uint8 delta; // old ^ new
+    };
+
+    struct Segment {
+        Uint64 startTime;
+        std::vector<Uint8> checkpoint; // State at startTime
+        std::vector<Uint8> records; // Encoded changes, one record per delta cycle
+        std::vector<Uint32> recordOffsets;
+        std::vector<Uint64> recordTimes;
+
+        size_t bytes() const;
+    };
+
+    std::deque<Segment> segments;
+    Segment spare; // Buffers of the last segment dropped from the front, reused by startSegment()
+    size_t cursorSegment = 0; // The cursor sits after cursorRecord records of segments[cursorSegment]
+    size_t cursorRecord = 0;
+    size_t used = 0;
+    bool rewound = false; // Cached isRewound(), checked on every record
+    Uint64 version = 0; // netlistVersion the history belongs to
+
+    // Changes not encoded yet, of several delta cycles. Record r ends before toggles[ends[r].toggles]
+    // and writes[ends[r].writes].
+    struct RecordEnd {
+        Uint32 toggles;
+        Uint32 writes;
+        Uint64 time;
+    };
+    static constexpr size_t BATCH_CHANGES = 1 << 12;
+    // Records kept per checkpoint at least, so small circuits don't take one every few delta cycles
+    static constexpr size_t MIN_SEGMENT_BYTES = 64 * 1024;
+    std::vector<Uint32> toggles; // Handle slots of the objects that changed
+    std::vector<MemoryWrite> writes;
+    std::vector<RecordEnd> ends;
+    Uint64 currentTime = 0;
+    std::vector<Uint8> scratch;
+
+    bool segmentFull() const;
+    void endRecord();
+    void flush();
+    void startSegment();
+    void truncateFuture();
+    void enforceBudget();
+    void apply(const Segment& segment, size_t record);
+    void finishNavigation();
+};
+
+#endif //JOURNAL_HPP
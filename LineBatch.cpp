@@ -0,0 +1,45 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "LineBatch.hpp"
+
+#include <cmath>
+
+static constexpr SDL_FColor COLORS[LineBatch::COLOR_COUNT] = {
+    {200 / 255.0f, 200 / 255.0f, 200 / 255.0f, 1.0f}, // LOW
+    {1.0f, 1.0f, 0.0f, 1.0f}, // HIGH
+    {85 / 255.0f, 136 / 255.0f, 1.0f, 1.0f}, // SELECTED
+};
+
+void LineBatch::add(const SDL_FPoint from, const SDL_FPoint to, const Color color) {
+    const float dx = to.x - from.x;
+    const float dy = to.y - from.y;
+    const float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0.0f) return;
+    // Half a pixel to either side of the line
+    const float nx = -dy / length * 0.5f;
+    const float ny = dx / length * 0.5f;
+
+    auto& [vertices, indices] = groups[color];
+    const int first = static_cast<int>(vertices.size());
+    vertices.push_back({{from.x + nx, from.y + ny}, COLORS[color], {}});
+    vertices.push_back({{to.x + nx, to.y + ny}, COLORS[color], {}});
+    vertices.push_back({{to.x - nx, to.y - ny}, COLORS[color], {}});
+    vertices.push_back({{from.x - nx, from.y - ny}, COLORS[color], {}});
+    for (const int corner : {0, 1, 2, 0, 2, 3}) {
+        indices.push_back(first + corner);
+    }
+}
+
+void LineBatch::flush(SDL_Renderer* renderer) {
+    for (auto& [vertices, indices] : groups) {
+        if (!vertices.empty()) {
+            SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()),
+                               indices.data(), static_cast<int>(indices.size()));
+        }
+        vertices.clear();
+        indices.clear();
+    }
+}
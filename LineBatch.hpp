@@ -0,0 +1,30 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef LINEBATCH_HPP
+#define LINEBATCH_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+// Collects the wires of a frame by colour and draws every colour with one SDL_RenderGeometry call.
+// SDL_RenderLines only draws connected polylines, so every segment becomes a one pixel wide quad.
+class LineBatch {
+public:
+    enum Color { LOW, HIGH, SELECTED, COLOR_COUNT }; // Drawn in this order, so selected wires end up on top
+
+    void add(SDL_FPoint from, SDL_FPoint to, Color color);
+    void flush(SDL_Renderer* renderer);
+
+private:
+    struct Group {
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+    };
+    Group groups[COLOR_COUNT];
+};
+
+extern LineBatch lineBatch;
+
+#endif //LINEBATCH_HPP
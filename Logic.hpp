@@ -0,0 +1,111 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef LOGIC_HPP
+#define LOGIC_HPP
+
+#include <SDL3/SDL.h>
+
+#include "Simulator.hpp"
+
+// What every kind of object computes, written once for all the engines: the objects themselves,
+// propagate()'s arrays, the regression instances and the fault models. Each engine reads its input
+// pins its own way and passes that in as pin(i), the wired OR of whatever drives input pin i, and
+// connected(i), whether anything drives it at all.
+
+// Gate function, bitwise so that word-parallel evaluators can run 64 patterns at once
+inline Uint64 gateFunction(const GateType type, const Uint64 a, const Uint64 b) {
+    switch (type) {
+        case BUF: return a;
+        case NOT: return ~a;
+        case AND: return a & b;
+        case OR: return a | b;
+        case NAND: return ~(a & b);
+        case NOR: return ~(a | b);
+        case XOR: return a ^ b;
+        case XNOR: return ~(a ^ b);
+    }
+    return 0;
+}
+
+// Output of a gate into out. Returns false, and the gate keeps its state, while an input it uses is
+// unconnected.
+template<typename Pin, typename Connected>
+bool evalGate(const GateType type, Pin pin, Connected connected, bool& out) {
+    const bool unary = type == BUF || type == NOT;
+    if (!connected(0) || (!unary && !connected(1))) return false;
+    out = gateFunction(type, pin(0), !unary && pin(1)) & 1;
+    return true;
+}
+
+// State a flip-flop takes at the next commit. lastClock is the clock level it saw last time, for
+// edge detection, and is updated.
+template<typename Pin>
+bool sampleFlipFlop(const FlipFlopType type, const bool state, bool& lastClock, Pin pin) {
+    bool next = state;
+    switch (type) {
+        case DFF:
+        case TFF: {
+            const bool clock = pin(1);
+            const bool risingEdge = clock && !lastClock;
+            lastClock = clock;
+            if (!risingEdge) break;
+            next = type == DFF ? pin(0) : state != pin(0);
+            break;
+        }
+        case JKFF: {
+            const bool clock = pin(2);
+            const bool risingEdge = clock && !lastClock;
+            lastClock = clock;
+            if (!risingEdge) break;
+            const bool j = pin(0);
+            const bool k = pin(1);
+            if (j && k) next = !state;
+            else if (j) next = true;
+            else if (k) next = false;
+            break;
+        }
+        case SR_LATCH: {
+            const bool s = pin(0);
+            const bool r = pin(1);
+            // S = R = 1 is invalid; hold the previous state
+            if (s && !r) next = true;
+            else if (r && !s) next = false;
+            break;
+        }
+        case D_LATCH:
+            if (pin(1)) next = pin(0);
+            break;
+    }
+    return next;
+}
+
+// Address on the first addressBits input pins of a memory
+template<typename Pin>
+Uint32 memoryAddress(const int addressBits, Pin pin) {
+    Uint32 address = 0;
+    for (int i = 0; i < addressBits; ++i) {
+        if (pin(i)) address |= 1u << i;
+    }
+    return address;
+}
+
+// Word a RAM writes at its address into data. Returns false while write enable, the last input pin
+// right after the data pins, is low.
+template<typename Pin>
+bool ramWrite(const int addressBits, Pin pin, Uint8& data) {
+    if (!pin(addressBits + Ram::DATA_BITS)) return false;
+    data = 0;
+    for (int i = 0; i < Ram::DATA_BITS; ++i) {
+        if (pin(addressBits + i)) data |= 1u << i;
+    }
+    return true;
+}
+
+// Word a ROM outputs, 0 past the end of its image
+inline Uint8 romWord(const Uint8* data, const size_t size, const Uint32 address) {
+    return address < size ? data[address] : 0;
+}
+
+#endif //LOGIC_HPP
@@ -0,0 +1,66 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "MappedFile.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const char* path) {
+    close();
+
+#ifdef _WIN32
+    size_t fileSize = 0;
+    void* fileData = SDL_LoadFile(path, &fileSize);
+    if (!fileData) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load %s: %s", path, SDL_GetError());
+        return false;
+    }
+    mapping = fileData;
+    length = fileSize;
+#else
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to open %s", path);
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "%s is empty or unreadable", path);
+        ::close(fd);
+        return false;
+    }
+
+    void* fileData = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping stays valid after the descriptor is closed
+    if (fileData == MAP_FAILED) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map %s", path);
+        return false;
+    }
+    mapping = fileData;
+    length = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (!mapping) return;
+#ifdef _WIN32
+    SDL_free(mapping);
+#else
+    munmap(mapping, length);
+#endif
+    mapping = nullptr;
+    length = 0;
+}
@@ -0,0 +1,30 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <SDL3/SDL.h>
+
+// Read-only view of a whole file. Memory-mapped on POSIX systems, read into memory elsewhere.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    const Uint8* data() const { return static_cast<const Uint8*>(mapping); }
+    size_t size() const { return length; }
+    bool isOpen() const { return mapping != nullptr; }
+
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+};
+
+#endif //MAPPEDFILE_HPP
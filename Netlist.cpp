@@ -0,0 +1,338 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Netlist.hpp"
+#include "Simulator.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <queue>
+
+bool Netlist::isStale() const {
+    return version != netlistVersion;
+}
+
+/**
+ * @brief Builds the fan-out arrays and a topological evaluation order of the given objects.
+ * @param objects Objects to compile. Their index field must match their position in the vector.
+ */
+void Netlist::compile(const std::vector<Object*>& objects) {
+    const auto n = static_cast<Uint32>(objects.size());
+    nodes = objects;
+    handles.resize(n);
+    for (Uint32 i = 0; i < n; ++i) handles[i] = objects[i]->handle;
+    order.clear();
+    inputs.clear();
+    outputs.clear();
+    clocks.clear();
+    sequential.clear();
+    level.assign(n, 1);
+    fanoutStart.assign(n + 1, 0);
+    fanout.clear();
+    pinStart.assign(n + 1, 0);
+    faninStart.clear();
+    fanin.clear();
+    faninPin.clear();
+
+    for (Uint32 i = 0; i < n; ++i) {
+        classify(objects[i], i);
+        appendRows(objects[i], i);
+    }
+    fanoutStart[n] = static_cast<Uint32>(fanout.size());
+    pinStart[n] = static_cast<Uint32>(faninStart.size());
+    faninStart.push_back(static_cast<Uint32>(fanin.size()));
+
+    // Kahn's algorithm over combinational nodes. Edges leaving a source are satisfied from the start.
+    std::vector<Uint32> pending(n, 0);
+    for (Uint32 i = 0; i < n; ++i) {
+        if (isSource(i)) continue;
+        for (Uint32 e = fanoutStart[i]; e < fanoutStart[i + 1]; ++e) {
+            if (!isSource(fanout[e])) pending[fanout[e]]++;
+        }
+    }
+
+    order.reserve(n);
+    for (Uint32 i = 0; i < n; ++i) {
+        if (!isSource(i) && pending[i] == 0) order.push_back(i);
+    }
+    for (size_t head = 0; head < order.size(); ++head) {
+        const Uint32 i = order[head];
+        for (Uint32 e = fanoutStart[i]; e < fanoutStart[i + 1]; ++e) {
+            const Uint32 dest = fanout[e];
+            if (isSource(dest)) continue;
+            level[dest] = std::max(level[dest], level[i] + 1);
+            if (--pending[dest] == 0) order.push_back(dest);
+        }
+    }
+
+    // Whatever is left sits on a combinational loop and cannot be levelized
+    const size_t levelized = order.size();
+    for (Uint32 i = 0; i < n; ++i) {
+        if (!isSource(i) && pending[i] != 0) order.push_back(i);
+    }
+    cyclic = order.size() - levelized;
+    if (cyclic > 0) {
+        SDL_Log("Warning: %zu objects are part of combinational loops and will be evaluated once per cycle.", cyclic);
+    }
+
+    affected = order;
+    orderRemoved.clear();
+    orderInserted.clear();
+    sourcesChanged = true;
+    version = netlistVersion;
+}
+
+void Netlist::classify(const Object* obj, const Uint32 node) {
+    if (obj->kind == KIND_BUTTON) inputs.push_back(node);
+    else if (obj->kind == KIND_LED) outputs.push_back(node);
+    else if (obj->kind == KIND_CLOCK) clocks.push_back(node);
+    if (obj->isSequential()) sequential.push_back(node);
+
+    level[node] = obj->isSequential() || obj->inputPins.empty() ? 0 : 1;
+}
+
+void Netlist::appendRows(const Object* obj, const Uint32 node) {
+    fanoutStart[node] = static_cast<Uint32>(fanout.size());
+    for (const auto& outputPin : obj->outputPins) {
+        for (const auto* outputObj : outputPin) {
+            if (outputObj) fanout.push_back(static_cast<Uint32>(outputObj->index));
+        }
+    }
+
+    // A wire remembers which output pin of its driver it's attached to; everything else
+    // is driven through wires, which only have one output
+    const auto driverPin = static_cast<Uint16>(obj->kind == KIND_WIRE ? static_cast<const Wire*>(obj)->outputPin : 0);
+    pinStart[node] = static_cast<Uint32>(faninStart.size());
+    for (const auto& inputPin : obj->inputPins) {
+        faninStart.push_back(static_cast<Uint32>(fanin.size()));
+        for (const auto* inputObj : inputPin) {
+            if (!inputObj) continue;
+            fanin.push_back(static_cast<Uint32>(inputObj->index));
+            faninPin.push_back(driverPin);
+        }
+    }
+}
+
+bool Netlist::update(const std::vector<Object*>& objects) {
+    if (version == netlistVersion && nodes.size() == objects.size()) {
+        affected.clear();
+        orderRemoved.clear();
+        orderInserted.clear();
+        sourcesChanged = false;
+        return true;
+    }
+    // Loops have no levels to patch
+    if (nodes.empty() || objects.empty() || cyclic > 0) {
+        compile(objects);
+        return false;
+    }
+
+    // Deleting an object moves the last one into its place, so the surviving nodes are found
+    // through their handles, at their current index
+    const auto oldCount = static_cast<Uint32>(nodes.size());
+    const auto n = static_cast<Uint32>(objects.size());
+    std::vector<Uint32> remap(oldCount, NO_NODE);
+    std::vector<Uint32> origin(n, NO_NODE);
+    for (Uint32 i = 0; i < oldCount; ++i) {
+        const Object* obj = objectSlots.get(handles[i]);
+        if (!obj || obj->index >= n || objects[obj->index] != obj) continue;
+        remap[i] = static_cast<Uint32>(obj->index);
+        origin[obj->index] = i;
+    }
+
+    // New and edited objects, including the neighbours of deleted ones, are re-read from their pins
+    std::vector<bool> dirty(n, false);
+    std::vector<Uint32> edited;
+    for (Uint32 i = 0; i < n; ++i) {
+        if (origin[i] == NO_NODE || objects[i]->edited > version) {
+            dirty[i] = true;
+            edited.push_back(i);
+        }
+    }
+
+    const auto oldFanoutStart = std::move(fanoutStart);
+    const auto oldFanout = std::move(fanout);
+    const auto oldPinStart = std::move(pinStart);
+    const auto oldFaninStart = std::move(faninStart);
+    const auto oldFanin = std::move(fanin);
+    const auto oldFaninPin = std::move(faninPin);
+    const auto oldLevel = std::move(level);
+    fanoutStart.assign(n + 1, 0);
+    fanout.clear();
+    fanout.reserve(oldFanout.size());
+    pinStart.assign(n + 1, 0);
+    faninStart.clear();
+    faninStart.reserve(oldFaninStart.size());
+    fanin.clear();
+    fanin.reserve(oldFanin.size());
+    faninPin.clear();
+    faninPin.reserve(oldFaninPin.size());
+    level.assign(n, 1);
+
+    // The kind of a node only changes if it was replaced, so the lists are filtered and the
+    // edited nodes classified again
+    const size_t sourceCount = clocks.size() + sequential.size();
+    for (auto* list : {&inputs, &outputs, &clocks, &sequential}) {
+        std::erase_if(*list, [&](Uint32& node) {
+            node = remap[node];
+            return node == NO_NODE || dirty[node];
+        });
+    }
+    sourcesChanged = clocks.size() + sequential.size() != sourceCount;
+
+    // Runs of unedited nodes have their rows back to back in the old arrays, so they are copied
+    // wholesale and only their offsets shifted. Node numbers need renaming only after a deletion.
+    const bool renumbered = std::ranges::find(remap, NO_NODE) != remap.end();
+    const auto rename = [&](const auto begin, const auto end) {
+        if (renumbered) std::transform(begin, end, begin, [&](const Uint32 node) { return remap[node]; });
+    };
+    nodes = objects;
+    handles.resize(n);
+    for (Uint32 i = 0; i < n; ++i) handles[i] = objects[i]->handle;
+    for (Uint32 i = 0; i < n;) {
+        if (dirty[i]) {
+            sourcesChanged = sourcesChanged || objects[i]->kind == KIND_CLOCK || objects[i]->isSequential();
+            classify(objects[i], i);
+            appendRows(objects[i], i);
+            ++i;
+            continue;
+        }
+
+        Uint32 end = i + 1;
+        while (end < n && !dirty[end] && origin[end] == origin[end - 1] + 1) ++end;
+        const Uint32 first = origin[i];
+        const Uint32 last = origin[end - 1] + 1;
+        std::copy(oldLevel.begin() + first, oldLevel.begin() + last, level.begin() + i);
+
+        const auto fanoutShift = static_cast<Uint32>(fanout.size()) - oldFanoutStart[first];
+        for (Uint32 k = i; k < end; ++k) fanoutStart[k] = oldFanoutStart[first + k - i] + fanoutShift;
+        fanout.insert(fanout.end(), oldFanout.begin() + oldFanoutStart[first], oldFanout.begin() + oldFanoutStart[last]);
+        rename(fanout.end() - (oldFanoutStart[last] - oldFanoutStart[first]), fanout.end());
+
+        const auto pinShift = static_cast<Uint32>(faninStart.size()) - oldPinStart[first];
+        for (Uint32 k = i; k < end; ++k) pinStart[k] = oldPinStart[first + k - i] + pinShift;
+        const Uint32 firstEdge = oldFaninStart[oldPinStart[first]];
+        const Uint32 lastEdge = oldFaninStart[oldPinStart[last]];
+        const auto faninShift = static_cast<Uint32>(fanin.size()) - firstEdge;
+        for (Uint32 pin = oldPinStart[first]; pin < oldPinStart[last]; ++pin) {
+            faninStart.push_back(oldFaninStart[pin] + faninShift);
+        }
+        fanin.insert(fanin.end(), oldFanin.begin() + firstEdge, oldFanin.begin() + lastEdge);
+        faninPin.insert(faninPin.end(), oldFaninPin.begin() + firstEdge, oldFaninPin.begin() + lastEdge);
+        rename(fanin.end() - (lastEdge - firstEdge), fanin.end());
+        i = end;
+    }
+    fanoutStart[n] = static_cast<Uint32>(fanout.size());
+    pinStart[n] = static_cast<Uint32>(faninStart.size());
+    faninStart.push_back(static_cast<Uint32>(fanin.size()));
+    for (auto* list : {&inputs, &outputs, &clocks, &sequential}) {
+        std::ranges::sort(*list);
+    }
+
+    // An unedited node pointing at a deleted one means an edit bypassed connect() and disconnect()
+    if (std::ranges::find(fanout, NO_NODE) != fanout.end() || std::ranges::find(fanin, NO_NODE) != fanin.end()) {
+        compile(objects);
+        return false;
+    }
+
+    // Levels are patched from the edited nodes forwards, stopping wherever a level comes out the
+    // same as before. Nodes are visited lowest level first, so most are settled on the first visit;
+    // one reached too early is simply visited again once its driver has moved.
+    using Entry = std::pair<Uint32, Uint32>; // Level, node
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+    std::vector<bool> moved(n, false);
+    const auto pushFanout = [&](const Uint32 node) {
+        for (Uint32 e = fanoutStart[node]; e < fanoutStart[node + 1]; ++e) {
+            if (!isSource(fanout[e])) queue.emplace(level[node] + 1, fanout[e]);
+        }
+    };
+    for (const Uint32 node : edited) {
+        const Uint32 before = origin[node] == NO_NODE ? NO_NODE : oldLevel[origin[node]];
+        moved[node] = true;
+        if (isSource(node)) {
+            if (before != 0) pushFanout(node);
+            continue;
+        }
+        level[node] = before;
+        queue.emplace(1, node);
+    }
+
+    affected.clear();
+    while (!queue.empty()) {
+        const Uint32 node = queue.top().second;
+        queue.pop();
+        Uint32 depth = 1;
+        for (Uint32 e = faninStart[pinStart[node]]; e < faninStart[pinStart[node + 1]]; ++e) {
+            if (!isSource(fanin[e])) depth = std::max(depth, level[fanin[e]] + 1);
+        }
+        // Only a feedback loop can push a level past the node count
+        if (depth > n) {
+            compile(objects);
+            return false;
+        }
+        if (depth == level[node]) continue;
+        level[node] = depth;
+        if (!moved[node]) {
+            moved[node] = true;
+            affected.push_back(node);
+        }
+        pushFanout(node);
+    }
+    for (const Uint32 node : edited) {
+        if (!isSource(node)) affected.push_back(node);
+    }
+
+    // The order stays sorted by level, which is topological. The moved nodes are taken out, and put
+    // back in by binary search, so the untouched stretches in between are copied as whole blocks.
+    orderRemoved.clear();
+    Uint32 position = 0;
+    std::erase_if(order, [&](Uint32& node) {
+        if (renumbered) node = remap[node];
+        const bool remove = node == NO_NODE || moved[node];
+        if (remove) orderRemoved.push_back(position);
+        position++;
+        return remove;
+    });
+    std::ranges::sort(affected, {}, [&](const Uint32 node) { return level[node]; });
+    std::vector<Uint32> kept = std::move(order);
+    order.clear();
+    order.reserve(kept.size() + affected.size());
+    orderInserted.clear();
+    auto from = kept.begin();
+    for (const Uint32 node : affected) {
+        const auto to = std::upper_bound(from, kept.end(), level[node], [&](const Uint32 depth, const Uint32 other) {
+            return depth < level[other];
+        });
+        order.insert(order.end(), from, to);
+        orderInserted.push_back(static_cast<Uint32>(order.size()));
+        order.push_back(node);
+        from = to;
+    }
+    order.insert(order.end(), from, kept.end());
+
+    version = netlistVersion;
+    return true;
+}
+
+std::vector<Uint32> Netlist::clockCone() const {
+    std::vector<bool> inCone(nodes.size(), false);
+    std::vector<Uint32> stack(clocks.begin(), clocks.end());
+    while (!stack.empty()) {
+        const Uint32 node = stack.back();
+        stack.pop_back();
+        for (Uint32 e = fanoutStart[node]; e < fanoutStart[node + 1]; ++e) {
+            const Uint32 dest = fanout[e];
+            if (isSource(dest) || inCone[dest]) continue;
+            inCone[dest] = true;
+            stack.push_back(dest);
+        }
+    }
+
+    std::vector<Uint32> cone;
+    for (const Uint32 node : order) {
+        if (inCone[node]) cone.push_back(node);
+    }
+    return cone;
+}
@@ -0,0 +1,70 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef NETLIST_HPP
+#define NETLIST_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "ObjectSlots.hpp"
+
+class Object;
+
+// A levelized snapshot of the object graph. Node i is objects[i] at the time of compilation.
+// Sequential objects and objects without inputs (buttons, clocks) are sources: they cut the
+// graph, so that every combinational node can be evaluated exactly once per cycle by walking
+// `order` from front to back.
+class Netlist {
+public:
+    std::vector<Object*> nodes;
+    std::vector<ObjectHandle> handles; // Of the nodes, to tell which of them still exist
+    std::vector<Uint32> order; // Combinational nodes in topological order
+    std::vector<Uint32> level; // Logic depth of every node, sources are level 0
+    std::vector<Uint32> inputs; // Buttons
+    std::vector<Uint32> outputs; // Leds
+    std::vector<Uint32> clocks;
+    std::vector<Uint32> sequential;
+
+    // Fan-out in compressed sparse row form: the nodes driven by node i are
+    // fanout[fanoutStart[i]] .. fanout[fanoutStart[i + 1] - 1]
+    std::vector<Uint32> fanoutStart;
+    std::vector<Uint32> fanout;
+
+    // Fan-in per input pin. Node i has the input pins pinStart[i] .. pinStart[i + 1] - 1, and pin p
+    // is driven by fanin[faninStart[p]] .. fanin[faninStart[p + 1] - 1] through their output pin faninPin[..]
+    std::vector<Uint32> pinStart;
+    std::vector<Uint32> faninStart;
+    std::vector<Uint32> fanin;
+    std::vector<Uint16> faninPin;
+
+    size_t cyclic = 0; // Combinational nodes caught in feedback loops, appended to the end of order
+    Uint64 version = 0; // netlistVersion this netlist was compiled from
+    std::vector<Uint32> affected; // Combinational nodes whose inputs may have changed in the last compile or update, in order
+    // How the last update() changed order, for engines that keep a copy of it: the positions in the
+    // previous order that were dropped, and those in the new order that were filled, both ascending
+    std::vector<Uint32> orderRemoved;
+    std::vector<Uint32> orderInserted;
+    bool sourcesChanged = true; // A clock or sequential node was added, removed or edited in the last compile or update
+
+    static constexpr Uint32 NO_NODE = 0xffffffff;
+
+    void compile(const std::vector<Object*>& objects);
+    /**
+     * @brief Brings the netlist up to date after objects were connected, disconnected, added or removed.
+     * Only the fan-out cone of the edited objects is re-levelized; the rows of every other node are copied.
+     * @return false if the netlist had to be compiled from scratch, e.g. because an edit closed a loop.
+     */
+    bool update(const std::vector<Object*>& objects);
+    bool isStale() const;
+    bool isSource(Uint32 node) const { return level[node] == 0; }
+    // Combinational nodes reachable from a clock without passing through a sequential object, in order
+    std::vector<Uint32> clockCone() const;
+
+private:
+    void classify(const Object* obj, Uint32 node);
+    void appendRows(const Object* obj, Uint32 node);
+};
+
+#endif //NETLIST_HPP
@@ -0,0 +1,26 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "ObjectSlots.hpp"
+
+ObjectHandle ObjectSlots::insert(Object* obj) {
+    if (freeSlots.empty()) {
+        slots.push_back(obj);
+        generations.push_back(0);
+        return {static_cast<Uint32>(slots.size() - 1), 0};
+    }
+    const Uint32 slot = freeSlots.back();
+    freeSlots.pop_back();
+    slots[slot] = obj;
+    return {slot, generations[slot]};
+}
+
+void ObjectSlots::remove(const ObjectHandle handle) {
+    if (!get(handle)) return;
+    slots[handle.slot] = nullptr;
+    // Outstanding handles to the slot stop resolving
+    generations[handle.slot]++;
+    freeSlots.push_back(handle.slot);
+}
@@ -0,0 +1,46 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef OBJECTSLOTS_HPP
+#define OBJECTSLOTS_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+class Object;
+
+// Stable reference to an object. Slots are reused after a deletion, but with the next generation,
+// so a handle to a deleted object resolves to nullptr instead of to its successor.
+struct ObjectHandle {
+    static constexpr Uint32 NO_SLOT = 0xffffffff;
+
+    Uint32 slot = NO_SLOT;
+    Uint32 generation = 0;
+
+    bool operator==(const ObjectHandle&) const = default;
+};
+
+// Slot map from handles to the live objects. Insertion, removal and lookup are O(1).
+class ObjectSlots {
+public:
+    ObjectHandle insert(Object* obj);
+    void remove(ObjectHandle handle);
+    Object* get(const ObjectHandle handle) const {
+        return handle.slot < slots.size() && generations[handle.slot] == handle.generation ? slots[handle.slot] : nullptr;
+    }
+    // The live object in a slot, whatever its generation, or nullptr
+    Object* at(const Uint32 slot) const { return slot < slots.size() ? slots[slot] : nullptr; }
+    size_t size() const { return slots.size() - freeSlots.size(); }
+    // Slots in use or free. Every handle's slot is below it.
+    size_t capacity() const { return slots.size(); }
+
+private:
+    std::vector<Object*> slots;
+    std::vector<Uint32> generations;
+    std::vector<Uint32> freeSlots;
+};
+
+extern ObjectSlots objectSlots;
+
+#endif //OBJECTSLOTS_HPP
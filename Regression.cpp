@@ -0,0 +1,169 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Regression.hpp"
+#include "Simulator.hpp"
+#include "Stimulus.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+void Regression::compile(const std::vector<Object*>& objects) {
+    circuit.compile(objects);
+    constraints.assign(circuit.netlist.inputs.size(), Constraint{});
+}
+
+bool Regression::loadExpected(const char* path, const Uint64 firstSeed, const size_t seeds, const Uint64 cycles) {
+    checker = nullptr;
+    StimulusReader reader;
+    if (!reader.open(path)) return false;
+    if (!reader.inputNames.empty()) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "%s drives inputs, expected outputs only.", path);
+        return false;
+    }
+
+    std::unordered_map<std::string, size_t> outputs;
+    for (size_t o = 0; o < circuit.netlist.outputs.size(); ++o) {
+        outputs[objectName(circuit.netlist.nodes[circuit.netlist.outputs[o]])] = o;
+    }
+    std::vector<size_t> columns;
+    for (const auto& name : reader.outputNames) {
+        const auto it = outputs.find(name);
+        if (it == outputs.end()) {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Expected output %s is not in the circuit.", name.c_str());
+            return false;
+        }
+        columns.push_back(it->second);
+    }
+
+    // Read-only once loaded, so the workers share it without locking
+    auto table = std::make_shared<std::vector<Uint8>>();
+    table->reserve(seeds * cycles * columns.size());
+    std::vector<Uint8> inputs, expected;
+    while (reader.next(inputs, expected)) {
+        table->insert(table->end(), expected.begin(), expected.end());
+    }
+    if (reader.failed() || table->size() != seeds * cycles * columns.size()) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "%s does not hold %zu seeds x %llu cycles.", path, seeds,
+            static_cast<unsigned long long>(cycles));
+        return false;
+    }
+
+    checker = [table, columns, firstSeed, cycles, names = reader.outputNames](
+        const CircuitInstance& instance, const Uint64 seed, const Uint64 cycle, std::string& message) {
+        const Uint8* row = table->data() + ((seed - firstSeed) * cycles + cycle) * columns.size();
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (row[c] == STIMULUS_X || row[c] == instance.output(columns[c])) continue;
+            message = names[c] + " is " + (row[c] ? "0" : "1") + ", expected " + (row[c] ? "1" : "0");
+            return false;
+        }
+        return true;
+    };
+    return true;
+}
+
+bool Regression::writeExpected(const char* path, const std::vector<Result>& results) const {
+    std::vector<std::string> names;
+    for (const Uint32 node : circuit.netlist.outputs) names.push_back(objectName(circuit.netlist.nodes[node]));
+
+    StimulusWriter writer;
+    if (!writer.open(path, {}, names, false)) return false;
+    if (names.empty()) return true;
+    std::vector<bool> expected(names.size());
+    for (const auto& result : results) {
+        for (auto row = result.outputs.begin(); row != result.outputs.end(); row += static_cast<std::ptrdiff_t>(names.size())) {
+            std::copy_n(row, names.size(), expected.begin());
+            writer.write({}, expected);
+        }
+    }
+    return true;
+}
+
+Regression::Result Regression::runSeed(CircuitInstance& instance, const Uint64 seed, const Uint64 cycles) const {
+    Result result;
+    result.seed = seed;
+    result.signature = 14695981039346656037ull; // FNV-1a
+
+    instance.reset();
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    const size_t inputs = circuit.netlist.inputs.size();
+    const size_t outputs = circuit.netlist.outputs.size();
+    std::vector<Uint32> held(inputs, 0);
+
+    for (Uint64 cycle = 0; cycle < cycles; ++cycle) {
+        for (size_t i = 0; i < inputs; ++i) {
+            if (held[i] > 0) {
+                held[i]--;
+                continue;
+            }
+            const auto& constraint = constraints[i];
+            instance.setInput(i, uniform(rng) < constraint.probability);
+            held[i] = std::max<Uint32>(1, constraint.hold) - 1;
+        }
+        instance.settle();
+        instance.cycle();
+
+        for (size_t o = 0; o < outputs; ++o) {
+            result.signature = (result.signature ^ instance.output(o)) * 1099511628211ull;
+            if (recordOutputs) result.outputs.push_back(instance.output(o));
+        }
+        if (checker && !checker(instance, seed, cycle, result.message)) {
+            result.passed = false;
+            result.failedCycle = cycle;
+            break;
+        }
+    }
+    return result;
+}
+
+std::vector<Regression::Result> Regression::run(const Uint64 firstSeed, const size_t seeds, const Uint64 cycles,
+                                                unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, seeds)));
+
+    std::vector<Result> results(seeds);
+    activity = ToggleCounter(circuit.netlist.nodes.size());
+    std::mutex activityMutex;
+    std::atomic<size_t> claimed = 0;
+    const auto work = [&] {
+        CircuitInstance instance(circuit);
+        ToggleCounter toggles(collectActivity ? circuit.netlist.nodes.size() : 0);
+        if (collectActivity) instance.countToggles(&toggles);
+        for (size_t k; (k = claimed.fetch_add(1)) < seeds;) {
+            results[k] = runSeed(instance, firstSeed + k, cycles);
+        }
+        if (collectActivity) {
+            std::lock_guard lock(activityMutex);
+            activity.merge(toggles);
+        }
+    };
+
+    const Uint64 start = SDL_GetTicks();
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+
+    const auto failed = std::ranges::count_if(results, [](const Result& r) { return !r.passed; });
+    SDL_Log("Regression: %zu seeds x %llu cycles on %u threads in %llu ms, %zu failed.", seeds,
+        static_cast<unsigned long long>(cycles), threads, static_cast<unsigned long long>(SDL_GetTicks() - start),
+        static_cast<size_t>(failed));
+    // Only list the first few failures, callers get all of them in the results
+    constexpr size_t MAX_REPORTED = 10;
+    size_t reported = 0;
+    for (const auto& result : results) {
+        if (!result.passed && reported++ < MAX_REPORTED) {
+            SDL_Log("  seed %llu failed at cycle %llu: %s", static_cast<unsigned long long>(result.seed),
+                static_cast<unsigned long long>(result.failedCycle), result.message.c_str());
+        }
+    }
+    return results;
+}
@@ -0,0 +1,69 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef REGRESSION_HPP
+#define REGRESSION_HPP
+
+#include <SDL3/SDL.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Activity.hpp"
+#include "CompiledCircuit.hpp"
+
+// Batch runner that drives the buttons of a circuit with seeded random vectors. Every seed runs
+// on its own CircuitInstance, so seeds are independent of each other and spread over all cores,
+// and a run can be reproduced from its seed alone.
+class Regression {
+public:
+    // Constrained-random stimulus for one input
+    struct Constraint {
+        float probability = 0.5f; // Chance of driving a 1; 0 or 1 ties the input
+        Uint32 hold = 1; // Cycles every drawn value is held for
+    };
+
+    struct Result {
+        Uint64 seed = 0;
+        bool passed = true;
+        Uint64 failedCycle = 0;
+        std::string message; // From the checker, when it fails
+        Uint64 signature = 0; // Hash of the outputs over the whole run, to compare runs
+        std::vector<bool> outputs; // Of every cycle, output after output, if recordOutputs is set
+    };
+
+    // Called after every cycle. Returns false and fills in the message when the outputs are wrong.
+    using Checker = std::function<bool(const CircuitInstance& instance, Uint64 seed, Uint64 cycle,
+                                       std::string& message)>;
+
+    CompiledCircuit circuit;
+    std::vector<Constraint> constraints; // Per input, numbered like circuit.netlist.inputs
+    Checker checker;
+    bool collectActivity = false; // Count toggles into activity, summed over all seeds
+    ToggleCounter activity;
+    bool recordOutputs = false;
+
+    void compile(const std::vector<Object*>& objects);
+
+    /**
+     * @brief Sets a checker that compares the outputs with a stimulus file, e.g. one written by
+     * writeExpected() from a run of a known-good circuit. The file has no inputs and one row per
+     * cycle of every seed, seed after seed; outputs are matched by name, x is not checked.
+     */
+    bool loadExpected(const char* path, Uint64 firstSeed, size_t seeds, Uint64 cycles);
+    // Writes the outputs recorded in results in the format loadExpected() reads
+    bool writeExpected(const char* path, const std::vector<Result>& results) const;
+
+    /**
+     * @brief Simulates the seeds firstSeed .. firstSeed + seeds - 1 for the given number of cycles each.
+     * @param threads Worker threads, 0 for one per core.
+     * @return One result per seed, in seed order.
+     */
+    std::vector<Result> run(Uint64 firstSeed, size_t seeds, Uint64 cycles, unsigned threads = 0);
+
+private:
+    Result runSeed(CircuitInstance& instance, Uint64 seed, Uint64 cycles) const;
+};
+
+#endif //REGRESSION_HPP
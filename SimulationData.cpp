@@ -0,0 +1,135 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "SimulationData.hpp"
+#include "Simulator.hpp"
+#include "Logic.hpp"
+
+void SimulationData::add(const Object* obj) {
+    const Uint32 slot = obj->handle.slot;
+    if (slot >= state.size()) {
+        state.resize(slot + 1);
+        queued.resize(slot + 1);
+        kind.resize(slot + 1);
+        rowDirty.resize(slot + 1);
+    }
+    state[slot] = 0;
+    queued[slot] = 0;
+    kind[slot] = obj->kind;
+    markDirty(obj);
+}
+
+void SimulationData::markDirty(const Object* obj) {
+    const Uint32 slot = obj->handle.slot;
+    if (rowDirty[slot]) return;
+    rowDirty[slot] = true;
+    dirtySlots.push_back(slot);
+}
+
+void SimulationData::refresh() {
+    if (version == netlistVersion) return;
+    version = netlistVersion;
+
+    // Patching appends new rows and leaves the old ones behind, so once as much has been appended as
+    // there was after the last rebuild, or a large part of the circuit changed, everything is rebuilt
+    const size_t slots = state.size();
+    if (op.empty() || dirtySlots.size() > slots / 4 || 2 * patched > rebuiltSize) {
+        rebuild();
+        return;
+    }
+
+    op.resize(slots, OP_OBJECT);
+    pinStart.resize(slots, 0);
+    fanoutStart.resize(slots, 0);
+    fanoutEnd.resize(slots, 0);
+    for (const Uint32 slot : dirtySlots) {
+        rowDirty[slot] = false;
+        // A deleted object's slot is never evaluated, and its neighbours are dirty themselves
+        if (const Object* obj = objectSlots.at(slot)) {
+            appendRows(obj);
+        } else {
+            fanoutEnd[slot] = fanoutStart[slot];
+        }
+    }
+    dirtySlots.clear();
+}
+
+void SimulationData::rebuild() {
+    const size_t slots = state.size();
+    op.assign(slots, OP_OBJECT);
+    pinStart.assign(slots, 0);
+    fanoutStart.assign(slots, 0);
+    fanoutEnd.assign(slots, 0);
+    faninStart.assign(1, 0);
+    fanin.clear();
+    fanout.clear();
+    // By slot, so the rows of objects next to each other in the arrays are next to each other too
+    for (Uint32 slot = 0; slot < slots; ++slot) {
+        if (const Object* obj = objectSlots.at(slot)) appendRows(obj);
+    }
+    for (const Uint32 slot : dirtySlots) rowDirty[slot] = false;
+    dirtySlots.clear();
+    patched = 0;
+    rebuiltSize = fanin.size() + fanout.size();
+}
+
+// Appends the fan-in and fan-out rows of obj and points its slot at them
+void SimulationData::appendRows(const Object* obj) {
+    const Uint32 slot = obj->handle.slot;
+    const size_t before = fanin.size() + fanout.size();
+
+    // The last entry of faninStart ends the last pin and starts the next one
+    pinStart[slot] = static_cast<Uint32>(faninStart.size() - 1);
+    bool singleOutputs = true; // Every driver reports its state on every output pin
+    for (const auto& pin : obj->inputPins) {
+        for (const auto* src : pin) {
+            const Uint32 driver = src->handle.slot;
+            fanin.push_back(driver);
+            singleOutputs = singleOutputs && kind[driver] != KIND_RAM && kind[driver] != KIND_ROM &&
+                            kind[driver] != KIND_FLIPFLOP;
+        }
+        faninStart.push_back(static_cast<Uint32>(fanin.size()));
+    }
+    fanoutStart[slot] = static_cast<Uint32>(fanout.size());
+    for (const auto& pin : obj->outputPins) {
+        for (const auto* dest : pin) {
+            if (dest) fanout.push_back(dest->handle);
+        }
+    }
+    fanoutEnd[slot] = static_cast<Uint32>(fanout.size());
+
+    if (obj->isSequential()) op[slot] = OP_SEQUENTIAL;
+    else if (obj->kind == KIND_GATE) op[slot] = static_cast<Op>(static_cast<const Gate*>(obj)->type);
+    else if (obj->kind == KIND_LED) op[slot] = OP_LED;
+    else if (obj->kind == KIND_WIRE && singleOutputs) op[slot] = OP_ANY;
+    else op[slot] = OP_OBJECT;
+    patched += fanin.size() + fanout.size() - before;
+}
+
+// Same results as Gate::eval(), Wire::eval() and Led::eval(), read from the arrays, see Logic.hpp
+bool SimulationData::eval(const Uint32 s) {
+    const Uint8 prevState = state[s];
+    const Uint32 pins = pinStart[s];
+    switch (op[s]) {
+        case OP_ANY:
+            state[s] = anyInput(pins);
+            return state[s] != prevState;
+        case OP_LED:
+            state[s] = anyInput(pins);
+            return false;
+        default:
+            break;
+    }
+
+    // A gate with an unconnected input keeps its state
+    if (op[s] >= OP_ANY) return false;
+    bool out;
+    if (!evalGate(static_cast<GateType>(op[s]), [&](const Uint32 pin) { return anyInput(pins + pin); },
+                  [&](const Uint32 pin) { return faninStart[pins + pin] != faninStart[pins + pin + 1]; }, out)) {
+        return false;
+    }
+    state[s] = out;
+    return state[s] != prevState;
+}
@@ -0,0 +1,77 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef SIMULATIONDATA_HPP
+#define SIMULATIONDATA_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "ObjectSlots.hpp"
+
+class Object;
+enum ObjectKind : Uint8;
+
+// What propagate() reads and writes for every event, in parallel arrays by handle slot, instead of
+// spread over the objects and their nested pin vectors. The states of a million gates take a
+// megabyte. The fan-in and fan-out lists are rows in shared arrays, read from the pins of the
+// objects. refresh() rewrites only the rows of objects edited since, and rebuilds everything once
+// the rows left behind add up.
+class SimulationData {
+public:
+    // How propagate() evaluates the object in a slot. Gates use their GateType.
+    enum Op : Uint8 {
+        OP_ANY = 8, // Any input high, e.g. a wire driven only by single-output objects
+        OP_LED, // Like OP_ANY, but has no outputs to queue
+        OP_OBJECT, // Object::eval(), for everything with state beyond the arrays
+        OP_SEQUENTIAL, // Waits in sequentialQueue until the combinational logic settles
+    };
+
+    std::vector<Uint8> state;
+    std::vector<Uint8> queued;
+    std::vector<ObjectKind> kind; // Object::kind, without going to the object
+
+    std::vector<Op> op;
+    // The input pins of slot s are numbered from pinStart[s], one per pin of the object. The slots
+    // driving pin p are fanin[faninStart[p]] .. fanin[faninStart[p + 1] - 1].
+    std::vector<Uint32> pinStart;
+    std::vector<Uint32> faninStart;
+    std::vector<Uint32> fanin;
+    // Objects on any output pin of slot s, by handle so they can be queued directly:
+    // fanout[fanoutStart[s]] .. fanout[fanoutEnd[s] - 1]
+    std::vector<Uint32> fanoutStart;
+    std::vector<Uint32> fanoutEnd;
+    std::vector<ObjectHandle> fanout;
+
+    // Makes room for a new object and resets its slot
+    void add(const Object* obj);
+    // Rereads the rows of obj on the next refresh(), after its connections changed or it was deleted
+    void markDirty(const Object* obj);
+    // Brings op and the fan-in and fan-out lists up to date if netlistVersion has changed since
+    void refresh();
+
+    // Evaluates slot s with one of the array ops. Returns whether its outputs must be queued.
+    bool eval(Uint32 s);
+
+private:
+    Uint64 version = ~0ull;
+    std::vector<Uint8> rowDirty; // By slot, whether it is in dirtySlots
+    std::vector<Uint32> dirtySlots;
+    size_t patched = 0; // Entries appended by refresh() since the last rebuild
+    size_t rebuiltSize = 0; // Entries after the last rebuild
+
+    void rebuild();
+    void appendRows(const Object* obj);
+
+    bool anyInput(const Uint32 pin) const {
+        for (Uint32 e = faninStart[pin]; e < faninStart[pin + 1]; ++e) {
+            if (state[fanin[e]]) return true;
+        }
+        return false;
+    }
+};
+
+extern SimulationData simulationData;
+
+#endif //SIMULATIONDATA_HPP
@@ -3,12 +3,23 @@
 //
 
 #include <SDL3/SDL.h>
-#include <SDL3_image/SDL_image.h>
 #include "Simulator.hpp"
-#include "Assets/Assets.hpp"
-
+#include "TextureCache.hpp"
+#include "SpriteBatch.hpp"
+#include "LineBatch.hpp"
+#include "Camera.hpp"
+#include "Logic.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <string>
 
+static constexpr SDL_FColor SELECTION_COLOR = {85 / 255.0f, 136 / 255.0f, 1.0f, 1.0f};
+static constexpr SDL_FColor LOW_COLOR = {200 / 255.0f, 200 / 255.0f, 200 / 255.0f, 1.0f};
+static constexpr SDL_FColor HIGH_COLOR = {1.0f, 1.0f, 0.0f, 1.0f};
+static constexpr SDL_FColor BLOCK_COLOR = {40 / 255.0f, 40 / 255.0f, 40 / 255.0f, 1.0f};
+
 std::string GateTypeToString(const GateType type) {
     switch (type) {
         case BUF: return "BUF";
@@ -23,105 +34,221 @@ std::string GateTypeToString(const GateType type) {
     }
 }
 
-Object::Object(const float x, const float y, const float rotation, const float scale) {
-    this->state = false;
-    this->queued = false;
-    this->pos = {x, y};
-    this->rot = rotation;
-    this->scale = scale;
-    this->w = 0.0;
-    this->h = 0.0;
-    this->selected = false;
-    this->dragging = false;
-    this->offsetX = 0.0;
-    this->offsetY = 0.0;
+std::string FlipFlopTypeToString(const FlipFlopType type) {
+    switch (type) {
+        case DFF: return "DFF";
+        case TFF: return "TFF";
+        case JKFF: return "JKFF";
+        case SR_LATCH: return "SR";
+        case D_LATCH: return "DLATCH";
+        default: return "UNKNOWN";
+    }
+}
+
+std::string objectName(const Object* obj) {
+    std::string type = "Object";
+    switch (obj->kind) {
+        case KIND_GATE: type = GateTypeToString(static_cast<const Gate*>(obj)->type); break;
+        case KIND_FLIPFLOP: type = FlipFlopTypeToString(static_cast<const FlipFlop*>(obj)->type); break;
+        case KIND_BUTTON: type = "Button"; break;
+        case KIND_CLOCK: type = "Clock"; break;
+        case KIND_WIRE: type = "Wire"; break;
+        case KIND_LED: type = "Led"; break;
+        case KIND_RAM: type = "RAM"; break;
+        case KIND_ROM: type = "ROM"; break;
+        default: break;
+    }
+    return type + "_" + std::to_string(obj->id);
+}
+
+static Uint64 nextObjectId = 0;
 
+Object::Object(const ObjectKind kind, const float x, const float y, const float rotation, const float scale) : kind(kind) {
+    this->index = objects.size();
     objects.push_back(this);
+    this->id = nextObjectId++;
+    this->handle = objectSlots.insert(this);
+    simulationData.add(this);
+    // A reused slot starts over with a fresh view
+    if (handle.slot >= objectViews.size()) objectViews.resize(handle.slot + 1);
+    ObjectView& view = this->view();
+    view = ObjectView{};
+    view.pos = {x, y};
+    view.rot = rotation;
+    view.scale = scale;
+    // Indexed once the subclass has set the size, drawn above everything created before it
+    spatialIndex.add(this);
+    this->kindIndex = objectsOfKind[kind].size();
+    objectsOfKind[kind].push_back(this);
+    netlistVersion++;
+    this->edited = netlistVersion;
 }
 
 Object::~Object() {
-    std::erase(objects, this);
-
-    for (auto &inputPin: inputPins) {
-        for (auto *connectedObj: inputPin) {
-            disconnect(connectedObj);
+    // The last object takes over the slot, so removal doesn't shift the rest of the vector
+    if (index < objects.size() && objects[index] == this) {
+        objects[index] = objects.back();
+        objects[index]->index = index;
+        objects.pop_back();
+    }
+    auto& sameKind = objectsOfKind[kind];
+    if (kindIndex < sameKind.size() && sameKind[kindIndex] == this) {
+        sameKind[kindIndex] = sameKind.back();
+        sameKind[kindIndex]->kindIndex = kindIndex;
+        sameKind.pop_back();
+    }
+    spatialIndex.remove(this);
+    view() = ObjectView{}; // Frees the pin positions and sprites until the slot is reused
+    objectSlots.remove(handle);
+    std::erase(sequentialQueue, this);
+    simulationData.markDirty(this);
+    netlistVersion++;
+
+    // Only the neighbours' entries need removing, this object's lists go with it
+    for (Uint32 pin = 0; pin < inputLinks.size(); ++pin) {
+        for (Uint32 slot = 0; slot < inputLinks[pin].size(); ++slot) {
+            const Link link = inputLinks[pin][slot];
+            inputPins[pin][slot]->removeOutput(link.pin, link.slot);
+            inputPins[pin][slot]->edited = netlistVersion;
+            spatialIndex.markDirty(inputPins[pin][slot]);
+            simulationData.markDirty(inputPins[pin][slot]);
         }
     }
-
-    for (auto &outputPin: outputPins) {
-        for (auto *connectedObj: outputPin) {
-            disconnect(connectedObj);
+    for (Uint32 pin = 0; pin < outputLinks.size(); ++pin) {
+        for (Uint32 slot = 0; slot < outputLinks[pin].size(); ++slot) {
+            const Link link = outputLinks[pin][slot];
+            outputPins[pin][slot]->removeInput(link.pin, link.slot);
+            outputPins[pin][slot]->edited = netlistVersion;
+            spatialIndex.markDirty(outputPins[pin][slot]);
+            simulationData.markDirty(outputPins[pin][slot]);
         }
     }
 }
 
 
 void Object::connect(Object *src, Object *dest, const int outputPin, const int inputPin) {
-    if (auto *wire = dynamic_cast<Wire *>(dest)) {
-        wire->outputPin = outputPin;
+    if (dest->kind == KIND_WIRE) {
+        static_cast<Wire *>(dest)->outputPin = outputPin;
     }
-    if (auto *wire = dynamic_cast<Wire *>(src)) {
-        wire->inputPin = inputPin;
+    if (src->kind == KIND_WIRE) {
+        static_cast<Wire *>(src)->inputPin = inputPin;
     }
+    if (src->outputLinks.size() < src->outputPins.size()) src->outputLinks.resize(src->outputPins.size());
+    if (dest->inputLinks.size() < dest->inputPins.size()) dest->inputLinks.resize(dest->inputPins.size());
+    src->outputLinks[outputPin].push_back({static_cast<Uint32>(inputPin), static_cast<Uint32>(dest->inputPins[inputPin].size())});
+    dest->inputLinks[inputPin].push_back({static_cast<Uint32>(outputPin), static_cast<Uint32>(src->outputPins[outputPin].size())});
     src->outputPins[outputPin].push_back(dest);
     dest->inputPins[inputPin].push_back(src);
-    eventQueue.push(src);
-    eventQueue.push(dest);
-    src->queued = true;
-    dest->queued = true;
+    eventQueue.push(src->handle);
+    eventQueue.push(dest->handle);
+    src->queued() = true;
+    dest->queued() = true;
+    netlistVersion++;
+    src->edited = netlistVersion;
+    dest->edited = netlistVersion;
+    // Wires span from pin to pin
+    spatialIndex.markDirty(src);
+    spatialIndex.markDirty(dest);
+    simulationData.markDirty(src);
+    simulationData.markDirty(dest);
 }
 
-// Disconnect this from another object.
+// Disconnect this from another object, in both directions. Costs the number of connections of this
+// object, not of the other one.
 void Object::disconnect(Object *obj) {
     if (!obj) return;
 
-    for (auto &inputPin: obj->inputPins) {
-        std::erase(inputPin, this);
+    for (Uint32 pin = 0; pin < inputLinks.size(); ++pin) {
+        // Backwards, so that the entries moved into removed slots have been looked at already
+        for (Uint32 slot = static_cast<Uint32>(inputLinks[pin].size()); slot-- > 0;) {
+            if (inputPins[pin][slot] != obj) continue;
+            obj->removeOutput(inputLinks[pin][slot].pin, inputLinks[pin][slot].slot);
+            removeInput(pin, slot);
+        }
     }
-    for (auto &outputPin: obj->outputPins) {
-        std::erase(outputPin, this);
+    for (Uint32 pin = 0; pin < outputLinks.size(); ++pin) {
+        for (Uint32 slot = static_cast<Uint32>(outputLinks[pin].size()); slot-- > 0;) {
+            if (outputPins[pin][slot] != obj) continue;
+            obj->removeInput(outputLinks[pin][slot].pin, outputLinks[pin][slot].slot);
+            removeOutput(pin, slot);
+        }
     }
+    netlistVersion++;
+    edited = netlistVersion;
+    obj->edited = netlistVersion;
+    spatialIndex.markDirty(this);
+    spatialIndex.markDirty(obj);
+    simulationData.markDirty(this);
+    simulationData.markDirty(obj);
 }
 
-
-Button::Button(SDL_Renderer *renderer, const float x, const float y) : Object(x, y, 1.0, 0.05) {
-    inputPins.resize(0);
-    outputPins.resize(1);
-    inputPinPos.resize(0);
-    outputPinPos.resize(1);
-    textures.resize(2);
-
-    SDL_IOStream* btn0 = SDL_IOFromConstMem(Button0_png, Button0_png_len);
-    SDL_IOStream* btn1 = SDL_IOFromConstMem(Button1_png, Button1_png_len);
-    if (!btn0 || !btn1) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create IOStream from memory: %s", SDL_GetError());
+void Object::removeInput(const Uint32 pin, const Uint32 slot) {
+    auto& pins = inputPins[pin];
+    auto& links = inputLinks[pin];
+    if (slot + 1 < pins.size()) {
+        pins[slot] = pins.back();
+        links[slot] = links.back();
+        pins[slot]->outputLinks[links[slot].pin][links[slot].slot].slot = slot;
     }
+    pins.pop_back();
+    links.pop_back();
+}
 
-    SDL_Surface* surface0 = IMG_Load_IO(btn0, 1);
-    SDL_Surface* surface1 = IMG_Load_IO(btn1, 1);
-    if (!surface0 || !surface1) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load image from IOStream: %s", SDL_GetError());
+void Object::removeOutput(const Uint32 pin, const Uint32 slot) {
+    auto& pins = outputPins[pin];
+    auto& links = outputLinks[pin];
+    if (slot + 1 < pins.size()) {
+        pins[slot] = pins.back();
+        links[slot] = links.back();
+        pins[slot]->inputLinks[links[slot].pin][links[slot].slot].slot = slot;
     }
-    textures[0] = SDL_CreateTextureFromSurface(renderer, surface0);
-    textures[1] = SDL_CreateTextureFromSurface(renderer, surface1);
+    pins.pop_back();
+    links.pop_back();
+}
 
-    if (!textures[0] || !textures[1]) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load texture: %s", SDL_GetError());
-        return;
+SDL_FRect Object::bounds() const {
+    const ObjectView& view = this->view();
+    return {view.pos.x, view.pos.y, view.w * view.scale, view.h * view.scale};
+}
+
+void Object::moveTo(const float x, const float y) {
+    view().pos = {x, y};
+    spatialIndex.markDirty(this);
+    for (const auto& pin: inputPins) {
+        for (auto* obj: pin) obj->attachedMoved();
+    }
+    for (const auto& pin: outputPins) {
+        for (auto* obj: pin) obj->attachedMoved();
     }
-    float w, h;
-    SDL_GetTextureSize(textures[0], &w, &h);
-    this->w = w;
-    this->h = h;
+}
+
 
-    outputPinPos[0] = {this->w - 20, h / 2};
+// At low zoom the details of a component can't be made out, so it is drawn as a rectangle in the
+// colour of its state, in the same batch as the sprites.
+static void renderFlat(SDL_Renderer* renderer, const Object* obj) {
+    const SDL_FColor color = obj->view().selected ? SELECTION_COLOR : obj->state() ? HIGH_COLOR : LOW_COLOR;
+    spriteBatch.fill(renderer, camera.toScreen(obj->bounds()), color);
 }
 
-Button::~Button() {
-    for (const auto texture: textures) {
-        if (texture) {
-            SDL_DestroyTexture(texture);
-        }
+Button::Button(SDL_Renderer *renderer, const float x, const float y) : Object(KIND_BUTTON, x, y, 1.0, 0.05) {
+    ObjectView& view = this->view();
+    inputPins.resize(0);
+    outputPins.resize(1);
+    view.inputPinPos.resize(0);
+    view.outputPinPos.resize(1);
+    view.sprites = {textureCache.get(renderer, ASSET_BUTTON0), textureCache.get(renderer, ASSET_BUTTON1)};
+    view.w = view.sprites[0].w;
+    view.h = view.sprites[0].h;
+
+    view.outputPinPos[0] = {view.w - 20, view.h / 2};
+}
+
+void Button::press() {
+    state() = !state();
+    notifyChange(this);
+    if (!queued()) {
+        eventQueue.push(handle);
+        queued() = true;
     }
 }
 
@@ -130,291 +257,223 @@ bool Button::eval() {
 }
 
 void Button::render(SDL_Renderer *renderer) {
-    if (selected) {
+    if (camera.lowDetail()) {
+        renderFlat(renderer, this);
+        return;
+    }
+    ObjectView& view = this->view();
+    if (view.selected) {
         SDL_FRect border;
-        border.x = pos.x - 4;
-        border.y = pos.y - 4;
-        border.w = w * scale + 8;
-        border.h = h * scale + 8;
+        border.x = view.pos.x - 4;
+        border.y = view.pos.y - 4;
+        border.w = view.w * view.scale + 8;
+        border.h = view.h * view.scale + 8;
 
-        SDL_SetRenderDrawColor(renderer, 85, 136, 255, 255);
-        SDL_RenderFillRect(renderer, &border);
+        spriteBatch.fill(renderer, camera.toScreen(border), SELECTION_COLOR);
     }
 
-    SDL_Texture *texture = state ? textures[1] : textures[0];
+    const Sprite& sprite = view.sprites[state() ? 1 : 0];
 
-    if (!texture) {
+    if (!sprite.texture) {
         return;
     }
 
-    SDL_FRect rect = {pos.x, pos.y, 0, 0};
-    SDL_GetTextureSize(texture, &rect.w, &rect.h);
-    rect.w *= scale;
-    rect.h *= scale;
-
-    SDL_RenderTexture(renderer, texture, nullptr, &rect);
+    spriteBatch.add(renderer, sprite,
+                    camera.toScreen({view.pos.x, view.pos.y, sprite.w * view.scale, sprite.h * view.scale}));
 }
 
 
-Clock::Clock(SDL_Renderer *renderer, const float x, float y, const float freq) : Object(x, y, 0, 0.05), freq(freq) {
+Clock::Clock(SDL_Renderer *renderer, const float x, float y, const float freq) : Object(KIND_CLOCK, x, y, 0, 0.05), freq(freq) {
+    ObjectView& view = this->view();
     inputPins.resize(0);
     outputPins.resize(1);
-    inputPinPos.resize(0);
-    outputPinPos.resize(1);
-    textures.resize(1);
+    view.inputPinPos.resize(0);
+    view.outputPinPos.resize(1);
+    view.sprites = {textureCache.get(renderer, ASSET_CLOCK)};
+    view.w = view.sprites[0].w;
+    view.h = view.sprites[0].h;
 
-    SDL_IOStream* rw = SDL_IOFromConstMem(CLK_png, CLK_png_len);
-    if (!rw) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create IOStream from memory: %s", SDL_GetError());
-    }
-
-    SDL_Surface* surface = IMG_Load_IO(rw, 1);
-    if (!surface) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load image from IOStream: %s", SDL_GetError());
-    }
-    textures[0] = SDL_CreateTextureFromSurface(renderer, surface);
-
-    float w, h;
-    SDL_GetTextureSize(textures[0], &w, &h);
-    this->w = w;
-    this->h = h;
-
-    outputPinPos[0] = {w - 20, h / 2};
-}
-
-Clock::~Clock() {
-    for (const auto texture: textures) {
-        if (texture) {
-            SDL_DestroyTexture(texture);
-        }
-    }
+    view.outputPinPos[0] = {view.w - 20, view.h / 2};
 }
 
 bool Clock::eval() {
-    static Uint64 last = 0;
-    static bool lastState = false;
     Uint64 now = SDL_GetTicks();
-    if (last == 0) last = now;
+    if (lastToggle == 0) lastToggle = now;
     float T = 1000.0f / freq / 2.0f;
-    if (now - last >= T) {
-        lastState = !lastState;
-        last = now;
+    if (now - lastToggle >= T) {
+        level = !level;
+        lastToggle = now;
     }
-    bool prevState = state;
-    state = lastState;
-    return state != prevState;
+    bool prevState = state();
+    state() = level;
+    return state() != prevState;
+}
+
+// The phase is kept as the time since the last toggle, so it carries over to another run
+void Clock::saveState(std::vector<Uint8>& out) const {
+    const Uint64 elapsed = lastToggle == 0 ? 0 : SDL_GetTicks() - lastToggle;
+    const auto* bytes = reinterpret_cast<const Uint8*>(&elapsed);
+    out.insert(out.end(), bytes, bytes + sizeof(elapsed));
+    out.push_back(level);
+}
+
+bool Clock::loadState(const Uint8* data, const size_t size) {
+    Uint64 elapsed = 0;
+    if (size != sizeof(elapsed) + 1) return false;
+    std::memcpy(&elapsed, data, sizeof(elapsed));
+    const Uint64 now = SDL_GetTicks();
+    // 0 keeps meaning not started, so a phase older than this run resumes as soon as possible
+    lastToggle = elapsed == 0 ? 0 : elapsed < now ? now - elapsed : 1;
+    level = data[sizeof(elapsed)];
+    return true;
 }
 
 void Clock::render(SDL_Renderer *renderer) {
-    if (selected) {
+    if (camera.lowDetail()) {
+        renderFlat(renderer, this);
+        return;
+    }
+    ObjectView& view = this->view();
+    if (view.selected) {
         SDL_FRect border;
-        border.x = pos.x - 2;
-        border.y = pos.y - 2;
-        border.w = w * scale - 3;
-        border.h = h * scale + 4;
+        border.x = view.pos.x - 2;
+        border.y = view.pos.y - 2;
+        border.w = view.w * view.scale - 3;
+        border.h = view.h * view.scale + 4;
 
-        SDL_SetRenderDrawColor(renderer, 85, 136, 255, 255);
-        SDL_RenderFillRect(renderer, &border);
+        spriteBatch.fill(renderer, camera.toScreen(border), SELECTION_COLOR);
     }
 
-    if (!textures[0]) {
+    if (!view.sprites[0].texture) {
         return;
     }
 
-    SDL_FRect rect = {pos.x, pos.y, 0, 0};
-    SDL_GetTextureSize(textures[0], &rect.w, &rect.h);
-    rect.w *= scale;
-    rect.h *= scale;
-
-    SDL_RenderTexture(renderer, textures[0], nullptr, &rect);
+    const Sprite& sprite = view.sprites[0];
+    spriteBatch.add(renderer, sprite,
+                    camera.toScreen({view.pos.x, view.pos.y, sprite.w * view.scale, sprite.h * view.scale}));
 }
 
 
 
-Gate::Gate(SDL_Renderer *renderer, const GateType type, const float x, const float y) : Object(x, y, 0, 0.05),
+Gate::Gate(SDL_Renderer *renderer, const GateType type, const float x, const float y) : Object(KIND_GATE, x, y, 0, 0.05),
     type(type) {
+    ObjectView& view = this->view();
     const bool isSingleInput = (type == NOT || type == BUF);
     inputPins.resize(isSingleInput ? 1 : 2);
-    inputPinPos.resize(isSingleInput ? 1 : 2);
+    view.inputPinPos.resize(isSingleInput ? 1 : 2);
     outputPins.resize(1);
-    outputPinPos.resize(1);
-    textures.resize(1);
-
-
-    SDL_IOStream* rw = nullptr;
-    switch (type) {
-        case BUF:
-            rw = SDL_IOFromConstMem(BUF_png, BUF_png_len);
-            break;
-        case NOT:
-            rw = SDL_IOFromConstMem(NOT_png, NOT_png_len);
-            break;
-        case AND:
-            rw = SDL_IOFromConstMem(AND_png, AND_png_len);
-            break;
-        case OR:
-            rw = SDL_IOFromConstMem(OR_png, OR_png_len);
-            break;
-        case NAND:
-            rw = SDL_IOFromConstMem(NAND_png, NAND_png_len);
-            break;
-        case NOR:
-            rw = SDL_IOFromConstMem(NOR_png, NOR_png_len);
-            break;
-        case XOR:
-            rw = SDL_IOFromConstMem(XOR_png, XOR_png_len);
-            break;
-        case XNOR:
-            rw = SDL_IOFromConstMem(XNOR_png, XNOR_png_len);
-            break;
-    }
-    
-    if (!rw) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create IOStream from memory: %s", SDL_GetError());
-    }
-
-    SDL_Surface* surface = IMG_Load_IO(rw, 1);
-    if (!surface) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load image from IOStream: %s", SDL_GetError());
-    }
-    textures[0] = SDL_CreateTextureFromSurface(renderer, surface);
-
-    if (!textures[0]) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load texture: %s", SDL_GetError());
-        return;
-    }
+    view.outputPinPos.resize(1);
 
-    float w, h;
-    SDL_GetTextureSize(textures[0], &w, &h);
-    this->w = w;
-    this->h = h;
+    view.sprites = {textureCache.get(renderer, static_cast<Asset>(ASSET_BUF + static_cast<int>(type)))};
+    view.w = view.sprites[0].w;
+    view.h = view.sprites[0].h;
     if (isSingleInput) {
-        inputPinPos[0] = {20, h / 2};
+        view.inputPinPos[0] = {20, view.h / 2};
     } else {
         constexpr float k = 10.0f / 45.0f;
         constexpr float k2 = 35.0f / 45.0f;
-        inputPinPos[0] = {20, k * h};
-        inputPinPos[1] = {20, k2 * h};
-    }
-    outputPinPos[0] = {w - 20, h / 2};
-}
-
-Gate::~Gate() {
-    for (const auto texture: textures) {
-        if (texture) {
-            SDL_DestroyTexture(texture);
-        }
+        view.inputPinPos[0] = {20, k * view.h};
+        view.inputPinPos[1] = {20, k2 * view.h};
     }
+    view.outputPinPos[0] = {view.w - 20, view.h / 2};
 }
 
 static bool evalPin(const std::vector<Object*>& pins) {
     bool ret = false;
     for (const auto pin: pins) {
-        ret |= pin->state;
+        ret |= pin->state();
     }
     return ret;
 }
 
 bool Gate::eval() {
-    const bool prevState = this->state;
+    const bool prevState = state();
     // This assumes only two input pins
     // For custom gates this code needs to change
-    if (inputPins[0].empty()) return false;
-    if (!(type == NOT || type == BUF) && inputPins[1].empty()) return false;
-
-    switch (type) {
-        case BUF:
-            state = evalPin(inputPins[0]);
-            break;
-        case NOT:
-            state = !evalPin(inputPins[0]);
-            break;
-        case AND:
-            state = evalPin(inputPins[0]) && evalPin(inputPins[1]);
-            break;
-        case OR:
-            state = evalPin(inputPins[0]) || evalPin(inputPins[1]);
-            break;
-        case NAND:
-            state = !(evalPin(inputPins[0]) && evalPin(inputPins[1]));
-            break;
-        case NOR:
-            state = !(evalPin(inputPins[0]) || evalPin(inputPins[1]));
-            break;
-        case XOR:
-            state = evalPin(inputPins[0]) != evalPin(inputPins[1]);
-            break;
-        case XNOR:
-            state = evalPin(inputPins[0]) == evalPin(inputPins[1]);
-            break;
-        default:
-            return false;
-    }
-    return (state != prevState);
+    bool out;
+    if (!evalGate(type, [&](const Uint32 pin) { return evalPin(inputPins[pin]); },
+                  [&](const Uint32 pin) { return !inputPins[pin].empty(); }, out)) {
+        return false;
+    }
+    state() = out;
+    return (state() != prevState);
 }
 
 void Gate::render(SDL_Renderer *renderer) {
-    if (selected) {
+    if (camera.lowDetail()) {
+        renderFlat(renderer, this);
+        return;
+    }
+    ObjectView& view = this->view();
+    if (view.selected) {
         SDL_FRect border;
-        border.x = pos.x + 5;
-        border.y = pos.y - 2;
-        border.w = w * scale - 10;
-        border.h = h * scale + 4;
+        border.x = view.pos.x + 5;
+        border.y = view.pos.y - 2;
+        border.w = view.w * view.scale - 10;
+        border.h = view.h * view.scale + 4;
 
-        SDL_SetRenderDrawColor(renderer, 85, 136, 255, 255);
-        SDL_RenderFillRect(renderer, &border);
+        spriteBatch.fill(renderer, camera.toScreen(border), SELECTION_COLOR);
     }
 
-    if (!textures[0]) {
+    if (!view.sprites[0].texture) {
         return;
     }
 
-    SDL_FRect rect = {pos.x, pos.y, 0, 0};
-    SDL_GetTextureSize(textures[0], &rect.w, &rect.h);
-    rect.w *= scale;
-    rect.h *= scale;
-
-    SDL_RenderTexture(renderer, textures[0], nullptr, &rect);
+    const Sprite& sprite = view.sprites[0];
+    spriteBatch.add(renderer, sprite,
+                    camera.toScreen({view.pos.x, view.pos.y, sprite.w * view.scale, sprite.h * view.scale}));
 }
 
-Wire::Wire(SDL_Renderer *renderer, const float x, const float y) : Object(x, y, 1.0, 1.0) {
+Wire::Wire(SDL_Renderer *renderer, const float x, const float y) : Object(KIND_WIRE, x, y, 1.0, 1.0) {
+    ObjectView& view = this->view();
     inputPins.resize(1);
-    inputPinPos.resize(1);
+    view.inputPinPos.resize(1);
     outputPins.resize(1);
-    outputPinPos.resize(1);
-    w = 100;
-    h = 5;
-    rot = 0;
+    view.outputPinPos.resize(1);
+    view.w = 100;
+    view.h = 5;
+    view.rot = 0;
     inputPin = 0;
     outputPin = 0;
 
-    inputPinPos[0] = {0, h / 2};
-    outputPinPos[0] = {w, h / 2};
+    view.inputPinPos[0] = {0, view.h / 2};
+    view.outputPinPos[0] = {view.w, view.h / 2};
 }
 
-Wire::~Wire() {
-    for (const auto texture: textures) {
-        if (texture) {
-            SDL_DestroyTexture(texture);
-        }
-    }
+bool Wire::eval() {
+    const bool prevState = state();
+    // Read the specific output pin the wire is attached to, so that objects
+    // with several outputs (e.g. memories) can drive different values.
+    state() = false;
+    for (const auto pin: inputPins[0]) {
+        state() |= pin->getOutput(outputPin);
+    }
+    return (state() != prevState);
 }
 
-bool Wire::eval() {
-    const bool prevState = this->state;
-    state = evalPin(inputPins[0]);
-    return (state != prevState);
+void Wire::attachedMoved() {
+    endsValid = false;
+    spatialIndex.markDirty(this);
 }
 
-void Wire::render(SDL_Renderer *renderer) {
-    if (selected) {
-        SDL_SetRenderDrawColor(renderer, 85, 136, 255, 255);
-    } else if (state) {
-        SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
-    } else {
-        SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
-    }
+bool Wire::endpoints(SDL_FPoint& start, SDL_FPoint& end) const {
+    if (inputPins[0].empty() || outputPins[0].empty()) return false;
+    const ObjectView& src = inputPins[0][0]->view();
+    const ObjectView& dest = outputPins[0][0]->view();
+    start = {src.pos.x + src.outputPinPos[outputPin].x * src.scale,
+             src.pos.y + src.outputPinPos[outputPin].y * src.scale};
+    end = {dest.pos.x + dest.inputPinPos[inputPin].x * dest.scale,
+           dest.pos.y + dest.inputPinPos[inputPin].y * dest.scale};
+    return true;
+}
+
+SDL_FRect Wire::bounds() const {
+    SDL_FPoint start, end;
+    if (!endpoints(start, end)) return {0, 0, -1, -1};
+    return {std::min(start.x, end.x), std::min(start.y, end.y), std::abs(end.x - start.x), std::abs(end.y - start.y)};
+}
 
+void Wire::render(SDL_Renderer *renderer) {
     // if (outputPins[0] == nullptr || inputPins[0] == nullptr) {
     //     return; // No connection, nothing to render
     // }
@@ -424,95 +483,323 @@ void Wire::render(SDL_Renderer *renderer) {
     // Technically wires are Objects so they could have multiple other Objects
     // connected to their input and output pins. This, of course, is not intended
     // and should not happen. We assume that wires are only connected to one object.
-    SDL_RenderLine(renderer,
-                   inputPins[0][0]->pos.x + inputPins[0][0]->outputPinPos[outputPin].x * inputPins[0][0]->scale,
-                   inputPins[0][0]->pos.y + inputPins[0][0]->outputPinPos[outputPin].y * inputPins[0][0]->scale,
-                   outputPins[0][0]->pos.x + outputPins[0][0]->inputPinPos[inputPin].x * outputPins[0][0]->scale,
-                   outputPins[0][0]->pos.y + outputPins[0][0]->inputPinPos[inputPin].y * outputPins[0][0]->scale);
+    if (!endsValid || endsEdited != edited) {
+        endpoints(ends[0], ends[1]);
+        endsValid = true;
+        endsEdited = edited;
+    }
+
+    // Wires within a pixel wouldn't show up between the components they connect
+    const SDL_FPoint from = camera.toScreen(ends[0].x, ends[0].y);
+    const SDL_FPoint to = camera.toScreen(ends[1].x, ends[1].y);
+    if (std::abs(to.x - from.x) < 1.0f && std::abs(to.y - from.y) < 1.0f) return;
+
+    lineBatch.add(from, to, view().selected ? LineBatch::SELECTED : state() ? LineBatch::HIGH : LineBatch::LOW);
 }
 
 
-Led::Led(SDL_Renderer *renderer, const float x, float y) : Object(x, y, 1.0, 0.05) {
+Led::Led(SDL_Renderer *renderer, const float x, float y) : Object(KIND_LED, x, y, 1.0, 0.05) {
+    ObjectView& view = this->view();
     inputPins.resize(1);
-    inputPinPos.resize(1);
+    view.inputPinPos.resize(1);
     outputPins.resize(0);
-    outputPinPos.resize(0);
-    textures.resize(2);
-    state = false;
+    view.outputPinPos.resize(0);
+    state() = false;
+
+    view.sprites = {textureCache.get(renderer, ASSET_LED0), textureCache.get(renderer, ASSET_LED1)};
+    view.w = view.sprites[0].w;
+    view.h = view.sprites[0].h;
 
-    SDL_IOStream* led0 = SDL_IOFromConstMem(Led0_png, Led0_png_len);
-    SDL_IOStream* led1 = SDL_IOFromConstMem(Led1_png, Led1_png_len);
-    if (!led0 || !led1) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create IOStream from memory: %s", SDL_GetError());
+    view.inputPinPos[0] = {20, view.h / 2};
+}
+
+bool Led::eval() {
+    state() = evalPin(inputPins[0]);
+    return false; // LEDs don't have output pins, so there are no other objects to notify
+}
+
+void Led::render(SDL_Renderer *renderer) {
+    if (camera.lowDetail()) {
+        renderFlat(renderer, this);
+        return;
     }
+    ObjectView& view = this->view();
+    if (view.selected) {
+        SDL_FRect border;
+        border.x = view.pos.x - 4;
+        border.y = view.pos.y - 4;
+        border.w = view.w * view.scale + 8;
+        border.h = view.h * view.scale + 8;
 
-    SDL_Surface* surface0 = IMG_Load_IO(led0, 1);
-    SDL_Surface* surface1 = IMG_Load_IO(led1, 1);
-    if (!surface0 || !surface1) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load image from IOStream: %s", SDL_GetError());
+        spriteBatch.fill(renderer, camera.toScreen(border), SELECTION_COLOR);
     }
-    textures[0] = SDL_CreateTextureFromSurface(renderer, surface0);
-    textures[1] = SDL_CreateTextureFromSurface(renderer, surface1);
 
-    if (!textures[0] || !textures[1]) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load texture: %s", SDL_GetError());
+    const Sprite& sprite = view.sprites[state() ? 1 : 0];
+
+    if (!sprite.texture) {
         return;
     }
-    float w, h;
-    SDL_GetTextureSize(textures[0], &w, &h);
-    this->w = w;
-    this->h = h;
 
-    inputPinPos[0] = {20, h / 2};
+    spriteBatch.add(renderer, sprite,
+                    camera.toScreen({view.pos.x, view.pos.y, sprite.w * view.scale, sprite.h * view.scale}));
 }
 
-Led::~Led() {
-    for (const auto texture: textures) {
-        if (texture) {
-            SDL_DestroyTexture(texture);
-        }
+
+static constexpr float MEMORY_PIN_SPACING = 25.0f;
+static constexpr float MEMORY_WIDTH = 80.0f;
+
+// Lay out the pins of a block component evenly along its left and right edges.
+static void layoutBlockPins(Object* obj) {
+    ObjectView& view = obj->view();
+    const size_t rows = std::max(view.inputPinPos.size(), view.outputPinPos.size());
+    view.w = MEMORY_WIDTH;
+    view.h = static_cast<float>(rows + 1) * MEMORY_PIN_SPACING;
+    for (size_t i = 0; i < view.inputPinPos.size(); ++i) {
+        view.inputPinPos[i] = {0, static_cast<float>(i + 1) * MEMORY_PIN_SPACING};
+    }
+    for (size_t i = 0; i < view.outputPinPos.size(); ++i) {
+        view.outputPinPos[i] = {view.w, static_cast<float>(i + 1) * MEMORY_PIN_SPACING};
     }
 }
 
-bool Led::eval() {
-    state = evalPin(inputPins[0]);
-    return false; // LEDs don't have output pins, so there are no other objects to notify
+// Components without a texture are drawn as a labelled box with pin markers.
+static void renderBlock(SDL_Renderer* renderer, const Object* obj, const char* label) {
+    if (camera.lowDetail()) {
+        renderFlat(renderer, obj);
+        return;
+    }
+    const ObjectView& view = obj->view();
+    if (view.selected) {
+        SDL_FRect border;
+        border.x = view.pos.x - 4;
+        border.y = view.pos.y - 4;
+        border.w = view.w * view.scale + 8;
+        border.h = view.h * view.scale + 8;
+
+        spriteBatch.fill(renderer, camera.toScreen(border), SELECTION_COLOR);
+    }
+
+    // The body and its one pixel outline go into the batch, so sprites queued later stay on top
+    const SDL_FRect body = camera.toScreen({view.pos.x, view.pos.y, view.w * view.scale, view.h * view.scale});
+    spriteBatch.fill(renderer, body, LOW_COLOR);
+    spriteBatch.fill(renderer, {body.x + 1, body.y + 1, body.w - 2, body.h - 2}, BLOCK_COLOR);
+    spriteBatch.text(body.x + 8, body.y + 6, label);
+
+    for (const auto& pin: view.inputPinPos) {
+        const SDL_FPoint at = camera.toScreen(view.pos.x + pin.x * view.scale, view.pos.y + pin.y * view.scale);
+        spriteBatch.fill(renderer, {at.x - 3, at.y - 3, 6, 6}, LOW_COLOR);
+    }
+    for (size_t i = 0; i < view.outputPinPos.size(); ++i) {
+        const auto& pin = view.outputPinPos[i];
+        const SDL_FPoint at = camera.toScreen(view.pos.x + pin.x * view.scale, view.pos.y + pin.y * view.scale);
+        spriteBatch.fill(renderer, {at.x - 3, at.y - 3, 6, 6}, obj->getOutput(static_cast<int>(i)) ? HIGH_COLOR : LOW_COLOR);
+    }
 }
 
-void Led::render(SDL_Renderer *renderer) {
-    if (selected) {
-        SDL_FRect border;
-        border.x = pos.x - 4;
-        border.y = pos.y - 4;
-        border.w = w * scale + 8;
-        border.h = h * scale + 8;
+// Reads an input pin of obj, for the functions in Logic.hpp
+static auto pinsOf(const Object* obj) {
+    return [obj](const Uint32 pin) { return evalPin(obj->inputPins[pin]); };
+}
+
+static Uint32 evalAddress(const Object* obj, const int addressBits) {
+    return memoryAddress(addressBits, pinsOf(obj));
+}
+
+
+Ram::Ram(SDL_Renderer *renderer, const float x, const float y, const int addressBits) : Object(KIND_RAM, x, y, 0, 1.0),
+    addressBits(addressBits) {
+    ObjectView& view = this->view();
+    inputPins.resize(addressBits + DATA_BITS + 1);
+    view.inputPinPos.resize(addressBits + DATA_BITS + 1);
+    outputPins.resize(DATA_BITS);
+    view.outputPinPos.resize(DATA_BITS);
+    memory.assign(static_cast<size_t>(1) << addressBits, 0);
+    output = 0;
+
+    layoutBlockPins(this);
+}
+
+bool Ram::eval() {
+    const Uint32 address = evalAddress(this, addressBits);
 
-        SDL_SetRenderDrawColor(renderer, 85, 136, 255, 255);
-        SDL_RenderFillRect(renderer, &border);
+    Uint8 data;
+    if (ramWrite(addressBits, pinsOf(this), data)) {
+        if (memory[address] != data) {
+            notifyMemoryWrite(this, address, memory[address], data);
+            memory[address] = data;
+        }
     }
 
-    SDL_Texture *texture = state ? textures[1] : textures[0];
+    const Uint8 prevOutput = output;
+    output = memory[address];
+    state() = output != 0;
+    return output != prevOutput;
+}
 
-    if (!texture) {
-        return;
+bool Ram::getOutput(const int pin) const {
+    return (output >> pin) & 1;
+}
+
+void Ram::saveState(std::vector<Uint8>& out) const {
+    out.push_back(output);
+    out.insert(out.end(), memory.begin(), memory.end());
+}
+
+bool Ram::loadState(const Uint8* data, const size_t size) {
+    if (size != memory.size() + 1) return false;
+    output = data[0];
+    std::copy_n(data + 1, memory.size(), memory.begin());
+    return true;
+}
+
+void Ram::resync() {
+    output = memory[evalAddress(this, addressBits)];
+}
+
+void Ram::render(SDL_Renderer *renderer) {
+    renderBlock(renderer, this, "RAM");
+}
+
+
+Rom::Rom(SDL_Renderer *renderer, const float x, const float y, const int addressBits) : Object(KIND_ROM, x, y, 0, 1.0),
+    addressBits(addressBits) {
+    ObjectView& view = this->view();
+    inputPins.resize(addressBits);
+    view.inputPinPos.resize(addressBits);
+    outputPins.resize(DATA_BITS);
+    view.outputPinPos.resize(DATA_BITS);
+    data = nullptr;
+    size = 0;
+    output = 0;
+
+    layoutBlockPins(this);
+}
+
+Rom::~Rom() {
+    unload();
+}
+
+/**
+ * @brief Maps a binary file as the contents of the ROM.
+ * @param path Path of the image to map. Byte N of the file is the word at address N.
+ * @return true if the file was mapped successfully.
+ */
+bool Rom::load(const char* path) {
+    unload();
+    if (!image.open(path)) return false;
+
+    data = image.data();
+    size = std::min(image.size(), static_cast<size_t>(1) << addressBits);
+    SDL_Log("Loaded ROM image %s (%zu bytes)", path, size);
+
+    if (!queued()) {
+        eventQueue.push(handle);
+        queued() = true;
     }
+    return true;
+}
 
-    SDL_FRect rect = {pos.x, pos.y, 0, 0};
-    SDL_GetTextureSize(texture, &rect.w, &rect.h);
-    rect.w *= scale;
-    rect.h *= scale;
+void Rom::unload() {
+    image.close();
+    data = nullptr;
+    size = 0;
+}
 
-    SDL_RenderTexture(renderer, texture, nullptr, &rect);
+bool Rom::eval() {
+    const Uint32 address = evalAddress(this, addressBits);
+
+    const Uint8 prevOutput = output;
+    output = romWord(data, size, address);
+    state() = output != 0;
+    return output != prevOutput;
+}
+
+bool Rom::getOutput(const int pin) const {
+    return (output >> pin) & 1;
+}
+
+void Rom::saveState(std::vector<Uint8>& out) const {
+    out.push_back(output);
+}
+
+bool Rom::loadState(const Uint8* data, const size_t size) {
+    if (size != 1) return false;
+    output = data[0];
+    return true;
+}
+
+void Rom::resync() {
+    output = romWord(data, size, evalAddress(this, addressBits));
 }
 
+void Rom::render(SDL_Renderer *renderer) {
+    renderBlock(renderer, this, "ROM");
+}
+
+
+FlipFlop::FlipFlop(SDL_Renderer *renderer, const FlipFlopType type, const float x, const float y) :
+    Object(KIND_FLIPFLOP, x, y, 0, 1.0), type(type) {
+    ObjectView& view = this->view();
+    inputPins.resize(type == JKFF ? 3 : 2);
+    view.inputPinPos.resize(type == JKFF ? 3 : 2);
+    outputPins.resize(2);
+    view.outputPinPos.resize(2);
+    lastClock = false;
+    nextState = false;
 
-FakeObject::FakeObject(SDL_Renderer *renderer, float x, float y) {
+    layoutBlockPins(this);
+}
+
+void FlipFlop::sample() {
+    nextState = sampleFlipFlop(type, state(), lastClock, pinsOf(this));
+}
+
+bool FlipFlop::commit() {
+    const bool prevState = state();
+    state() = nextState;
+    return state() != prevState;
+}
+
+bool FlipFlop::eval() {
+    sample();
+    return commit();
+}
+
+bool FlipFlop::getOutput(const int pin) const {
+    return pin == 0 ? state() : !state();
+}
+
+void FlipFlop::saveState(std::vector<Uint8>& out) const {
+    out.push_back(static_cast<Uint8>(lastClock | nextState << 1));
+}
+
+bool FlipFlop::loadState(const Uint8* data, const size_t size) {
+    if (size != 1) return false;
+    lastClock = data[0] & 1;
+    nextState = data[0] & 2;
+    return true;
+}
+
+void FlipFlop::resync() {
+    // Edge detection restarts from the current clock level
+    if (type == DFF || type == TFF) lastClock = evalPin(inputPins[1]);
+    else if (type == JKFF) lastClock = evalPin(inputPins[2]);
+    nextState = state();
+}
+
+void FlipFlop::render(SDL_Renderer *renderer) {
+    renderBlock(renderer, this, FlipFlopTypeToString(type).c_str());
+}
+
+
+FakeObject::FakeObject(SDL_Renderer *renderer, float x, float y) : Object(KIND_FAKE, x, y) {
+    ObjectView& view = this->view();
     inputPins.resize(1);
     outputPins.resize(1);
-    inputPinPos.resize(1);
-    outputPinPos.resize(1);
-    inputPinPos[0] = {0, 0};
-    outputPinPos[0] = {0, 0};
+    view.inputPinPos.resize(1);
+    view.outputPinPos.resize(1);
+    view.inputPinPos[0] = {0, 0};
+    view.outputPinPos[0] = {0, 0};
 }
 
 bool FakeObject::eval() {
@@ -522,3 +809,76 @@ bool FakeObject::eval() {
 void FakeObject::render(SDL_Renderer *renderer) {
     // No rendering logic for fake objects
 }
+
+
+static void queueOutputs(const Uint32 slot) {
+    auto& queued = simulationData.queued;
+    for (Uint32 e = simulationData.fanoutStart[slot]; e < simulationData.fanoutEnd[slot]; ++e) {
+        const ObjectHandle dest = simulationData.fanout[e];
+        if (!queued[dest.slot]) {
+            eventQueue.push(dest);
+            queued[dest.slot] = true;
+        }
+    }
+}
+
+int propagate(const int maxSteps) {
+    // Edits since the last call show up in the fan-in and fan-out lists. The loop below runs on the
+    // arrays and only goes to the object for listeners and the ops the arrays can't evaluate.
+    simulationData.refresh();
+    auto& state = simulationData.state;
+    auto& queued = simulationData.queued;
+    const auto& op = simulationData.op;
+
+    int steps = 0;
+    while (steps < maxSteps && (!eventQueue.empty() || !sequentialQueue.empty())) {
+        while (!eventQueue.empty() && steps < maxSteps) {
+            // Everything queued at the start of a delta cycle belongs to it; events it
+            // causes are processed one delta cycle later
+            if (deltaRemaining == 0) deltaRemaining = eventQueue.size();
+
+            const ObjectHandle handle = eventQueue.front();
+            Object* obj = objectSlots.get(handle);
+            eventQueue.pop();
+            steps++;
+            if (!obj) {
+                // Deleted after it was queued
+                if (--deltaRemaining == 0) advanceTime();
+                continue;
+            }
+
+            const Uint32 slot = handle.slot;
+            // Sequential objects stay queued until the combinational logic has settled
+            if (op[slot] == SimulationData::OP_SEQUENTIAL) {
+                sequentialQueue.push_back(obj);
+            } else {
+                const Uint8 prevState = state[slot];
+                const bool changed = op[slot] == SimulationData::OP_OBJECT ? obj->eval() : simulationData.eval(slot);
+                if (state[slot] != prevState) notifyChange(obj);
+                if (changed) queueOutputs(slot);
+                queued[slot] = false;
+            }
+
+            if (--deltaRemaining == 0) advanceTime();
+        }
+
+        if (!eventQueue.empty()) break;
+
+        // Sample everything first so that no flip-flop sees another one's new state
+        for (auto* obj : sequentialQueue) {
+            obj->sample();
+        }
+        for (auto* obj : sequentialQueue) {
+            queued[obj->handle.slot] = false;
+            if (obj->commit()) {
+                notifyChange(obj);
+                queueOutputs(obj->handle.slot);
+            }
+        }
+        if (!sequentialQueue.empty()) {
+            sequentialQueue.clear();
+            advanceTime();
+        }
+    }
+    return steps;
+}
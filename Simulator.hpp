@@ -6,61 +6,143 @@
 #define SIMULATOR_HPP
 
 #include <SDL3/SDL.h>
+#include <deque>
 #include <queue>
+#include <string>
 #include <vector>
 
+#include "MappedFile.hpp"
+#include "ObjectSlots.hpp"
+#include "SimulationData.hpp"
+#include "SpatialIndex.hpp"
+#include "TextureCache.hpp"
+
 class Object;
+class ChangeListener;
 
 enum InputDeviceType { BUTTON, SWITCH };
 
 enum GateType { BUF, NOT, AND, OR, NAND, NOR, XOR, XNOR };
 
+enum FlipFlopType { DFF, TFF, JKFF, SR_LATCH, D_LATCH };
+
+// Concrete class of an object, to dispatch on without RTTI
+enum ObjectKind : Uint8 { KIND_BUTTON, KIND_CLOCK, KIND_GATE, KIND_WIRE, KIND_LED, KIND_RAM, KIND_ROM, KIND_FLIPFLOP, KIND_FAKE, KIND_COUNT };
+
 typedef struct Coords {
     float x, y;
 } Coords;
 
+// Editor and rendering data of an object. The simulation never reads it, so it is kept apart from
+// the objects, in objectViews, and propagating events doesn't drag it through the cache.
+struct ObjectView {
+    Coords pos{};
+    float rot = 0.0f; // Rotation angle in radians, ONLY for wires
+    float scale = 1.0f;
+    float w = 0.0f, h = 0.0f;
+
+    // Relative coordinates, not adjusted for scale or rotation
+    std::vector<Coords> inputPinPos;
+    // Relative coordinates, not adjusted for scale or rotation
+    std::vector<Coords> outputPinPos;
+
+    bool selected = false;
+    bool dragging = false;
+    float offsetX = 0.0f, offsetY = 0.0f;
+
+    std::vector<Sprite> sprites; // Images in the shared atlas, one per visual state
+};
+
 extern std::vector<Object*> objects; // Global vector to hold all objects in the simulation
 extern std::vector<Object*> selectedObjects; // Global vector to hold selected objects
-extern std::queue<Object*> eventQueue;
+extern std::vector<Object*> objectsOfKind[KIND_COUNT]; // Every object by kind, e.g. all clocks, in no particular order
+extern std::queue<ObjectHandle> eventQueue; // Handles, so objects deleted while queued are skipped
+extern std::vector<Object*> sequentialQueue; // Sequential objects waiting for the combinational logic to settle
+extern Uint64 netlistVersion; // Bumped whenever objects or connections are added or removed
+extern Uint64 simTime; // Virtual time in delta cycles, one unit per wave of events through the queue
+extern size_t deltaRemaining; // Events of the current delta cycle still waiting in the queue
+extern std::vector<ChangeListener*> changeListeners; // Observers of every state change made by the engines
+extern std::deque<ObjectView> objectViews; // By handle slot. A deque, so views don't move when it grows.
 
+// The state and queued flag of an object live in simulationData, by handle slot, where propagate()
+// reads them along with the fan-in and fan-out. The pins here are what the netlist is edited through.
 class Object {
 public:
-    bool state;
-    bool queued;
+    const ObjectKind kind;
+    ObjectHandle handle; // Stable for the lifetime of the object, see objectSlots
 
-    Coords pos{};
-    float rot; // Rotation angle in radians, ONLY for wires
-    float scale;
-    float w, h;
+    Uint8& state() { return simulationData.state[handle.slot]; }
+    bool state() const { return simulationData.state[handle.slot]; }
+    Uint8& queued() { return simulationData.queued[handle.slot]; }
+    bool queued() const { return simulationData.queued[handle.slot]; }
 
     std::vector<std::vector<Object*>> inputPins; // Input pins for the object
     std::vector<std::vector<Object*>> outputPins; // Output pins for the object
-    // Relative coordinates, not adjusted for scale or rotation
-    std::vector<Coords> inputPinPos;
-    // Relative coordinates, not adjusted for scale or rotation
-    std::vector<Coords> outputPinPos;
 
-    bool selected;
-    bool dragging;
-    float offsetX, offsetY;
+    size_t index; // Position of the object in the objects vector, changes when other objects are deleted
+    // Creation order, never reused unlike handle slots: names the object and orders the drawing
+    Uint64 id;
+    size_t kindIndex; // Position of the object in objectsOfKind[kind]
+    Uint64 edited; // netlistVersion of the last change to this object's connections
+    // Where every connection is listed at its other end, so that it can be removed from both ends
+    // in O(1): the object in inputPins[p][k] lists this one in its outputPins[link.pin][link.slot],
+    // with link = inputLinks[p][k], and likewise for the outputs. Kept up by connect() and disconnect().
+    struct Link {
+        Uint32 pin;
+        Uint32 slot;
+    };
+    std::vector<std::vector<Link>> inputLinks;
+    std::vector<std::vector<Link>> outputLinks;
 
-    std::vector<SDL_Texture*> textures;
-
-    explicit Object(float x = 0.0, float y = 0.0, float rotation = 0.0, float scale = 1.0);
+    explicit Object(ObjectKind kind, float x = 0.0, float y = 0.0, float rotation = 0.0, float scale = 1.0);
     virtual ~Object();
 
     virtual bool eval() = 0;
     virtual void render(SDL_Renderer* renderer) = 0;
+    // State of a single output pin. Objects with one output simply report their state.
+    virtual bool getOutput(int pin) const { return state(); }
+
+    // Sequential objects are not evaluated inside the combinational propagation loop.
+    // Instead, once the logic has settled, all of them sample their inputs and then
+    // all of them commit their new state. See propagate().
+    virtual bool isSequential() const { return false; }
+    virtual void sample() {}
+    virtual bool commit() { return false; }
+
+    // Checkpoints capture `state` for every object; objects with further internal state
+    // (memory contents, clock phase, edge detection) append it here and read it back in loadState.
+    virtual void saveState(std::vector<Uint8>& out) const {}
+    virtual bool loadState(const Uint8* data, size_t size) { return size == 0; }
+    // Recomputes internal state that is derived from the inputs, after the states of the
+    // objects were rewound from outside (see Journal). Must not have side effects.
+    virtual void resync() {}
 
     static void connect(Object* src, Object* dest, int outputPin = 0, int inputPin = 0);
     void disconnect(Object* obj);
+
+    ObjectView& view() { return objectViews[handle.slot]; }
+    const ObjectView& view() const { return objectViews[handle.slot]; }
+    // Area the object covers in the canvas, negative width or height if it has none
+    virtual SDL_FRect bounds() const;
+
+    // Moves the object and lets the objects attached to its pins know, e.g. to re-route wires
+    void moveTo(float x, float y);
+    virtual void attachedMoved() {}
+
+private:
+    // Drop one entry from this end only, moving the last entry of the pin into its place
+    void removeInput(Uint32 pin, Uint32 slot);
+    void removeOutput(Uint32 pin, Uint32 slot);
 };
 
 class Button final : public Object {
 public:
     explicit Button(SDL_Renderer* renderer, float x = 0.0, float y = 0.0);
-    ~Button() override;
+    ~Button() override = default;
 
+    // Toggles the button like a click does: the change is reported to the changeListeners, and the
+    // button queued so its outputs follow
+    void press();
     bool eval() override;
     void render(SDL_Renderer* renderer) override;
 };
@@ -69,17 +151,23 @@ class Clock final : public Object {
 public:
     float freq;
     explicit Clock(SDL_Renderer* renderer, float x = 0.0, float y = 0.0, float freq = 1.0);
-    ~Clock() override;
+    ~Clock() override = default;
 
     bool eval() override;
     void render(SDL_Renderer* renderer) override;
+    void saveState(std::vector<Uint8>& out) const override;
+    bool loadState(const Uint8* data, size_t size) override;
+
+private:
+    Uint64 lastToggle = 0; // SDL_GetTicks() of the last toggle, 0 until the first eval
+    bool level = false;
 };
 
 class Gate final : public Object {
 public:
     GateType type;
     explicit Gate(SDL_Renderer* renderer, GateType type, float x = 0.0, float y = 0.0);
-    ~Gate() override;
+    ~Gate() override = default;
 
     bool eval() override;
     void render(SDL_Renderer* renderer) override;
@@ -92,21 +180,106 @@ public:
     // outputPin refers to the output pin of the object that the wire's input pin is connected to.
 
     explicit Wire(SDL_Renderer* renderer, float x = 0.0, float y = 0.0);
-    ~Wire() override;
+    ~Wire() override = default;
 
     bool eval() override;
     void render(SDL_Renderer* renderer) override;
+    void attachedMoved() override;
+    SDL_FRect bounds() const override;
+    // Pin positions the wire runs between, false if either end is unconnected
+    bool endpoints(SDL_FPoint& start, SDL_FPoint& end) const;
+
+private:
+    // Pin positions of the two ends, kept until an attached object moves or the wire is reconnected
+    SDL_FPoint ends[2]{};
+    bool endsValid = false;
+    Uint64 endsEdited = 0; // `edited` when the ends were computed
 };
 
 class Led final : public Object {
 public:
     explicit Led(SDL_Renderer* renderer, float x = 0.0, float y = 0.0);
-    ~Led() override;
+    ~Led() override = default;
 
     bool eval() override;
     void render(SDL_Renderer* renderer) override;
 };
 
+// Word-addressed RAM backed by a flat byte array.
+// Input pins: A0..A(addressBits-1), D0..D7, WE. Output pins: Q0..Q7.
+// Writes happen while WE is high; reads are asynchronous.
+class Ram final : public Object {
+public:
+    static constexpr int DATA_BITS = 8;
+
+    int addressBits;
+    std::vector<Uint8> memory;
+    Uint8 output;
+
+    explicit Ram(SDL_Renderer* renderer, float x = 0.0, float y = 0.0, int addressBits = 8);
+    ~Ram() override = default;
+
+    bool eval() override;
+    void render(SDL_Renderer* renderer) override;
+    bool getOutput(int pin) const override;
+    void saveState(std::vector<Uint8>& out) const override;
+    bool loadState(const Uint8* data, size_t size) override;
+    void resync() override;
+};
+
+// Read-only memory whose contents are memory-mapped from a binary file.
+// Input pins: A0..A(addressBits-1). Output pins: Q0..Q7.
+// Addresses past the end of the file read as zero.
+class Rom final : public Object {
+public:
+    static constexpr int DATA_BITS = 8;
+
+    int addressBits;
+    const Uint8* data;
+    size_t size;
+    Uint8 output;
+
+    explicit Rom(SDL_Renderer* renderer, float x = 0.0, float y = 0.0, int addressBits = 8);
+    ~Rom() override;
+
+    bool load(const char* path);
+    void unload();
+
+    bool eval() override;
+    void render(SDL_Renderer* renderer) override;
+    bool getOutput(int pin) const override;
+    void saveState(std::vector<Uint8>& out) const override;
+    bool loadState(const Uint8* data, size_t size) override;
+    void resync() override;
+
+private:
+    MappedFile image;
+};
+
+// Edge-triggered flip-flops (rising edge) and level-sensitive latches.
+// Input pins: DFF: D, CLK. TFF: T, CLK. JKFF: J, K, CLK. SR_LATCH: S, R. D_LATCH: D, EN.
+// Output pins: Q, /Q.
+class FlipFlop final : public Object {
+public:
+    FlipFlopType type;
+    bool lastClock;
+    bool nextState;
+
+    explicit FlipFlop(SDL_Renderer* renderer, FlipFlopType type, float x = 0.0, float y = 0.0);
+    ~FlipFlop() override = default;
+
+    bool eval() override;
+    void render(SDL_Renderer* renderer) override;
+    bool getOutput(int pin) const override;
+    void saveState(std::vector<Uint8>& out) const override;
+    bool loadState(const Uint8* data, size_t size) override;
+    void resync() override;
+
+    bool isSequential() const override { return true; }
+    void sample() override;
+    bool commit() override;
+};
+
 class FakeObject final : public Object {
 public:
     explicit FakeObject(SDL_Renderer* renderer, float x = 0.0, float y = 0.0);
@@ -116,4 +289,60 @@ public:
     void render(SDL_Renderer* renderer) override;
 };
 
+// Observes the simulation as it runs. Engines report every change of an object's state, every
+// memory write and every advance of simTime to all registered changeListeners.
+class ChangeListener {
+public:
+    virtual ~ChangeListener() = default;
+
+    // Listeners that only need to know which objects changed can point this at a buffer. Changes
+    // are then appended to it as handle slots, without a virtual call to onChange().
+    std::vector<Uint32>* changedSlots = nullptr;
+
+    virtual void onChange(const Object* obj) = 0;
+    virtual void onMemoryWrite(const Object* obj, Uint32 address, Uint8 oldValue, Uint8 newValue) {}
+    // Called after simTime was incremented, between two delta cycles
+    virtual void onTimeAdvance() {}
+};
+
+inline void notifyChange(const Object* obj) {
+    for (auto* listener : changeListeners) {
+        if (listener->changedSlots) listener->changedSlots->push_back(obj->handle.slot);
+        else listener->onChange(obj);
+    }
+}
+
+// Evaluates obj and reports it to the listeners if its state changed. Returns the result of
+// eval(), which can be true without a change of state (buttons, memories whose data changed).
+inline bool evalAndNotify(Object* obj) {
+    const bool prevState = obj->state();
+    const bool changed = obj->eval();
+    if (obj->state() != prevState) notifyChange(obj);
+    return changed;
+}
+
+inline void notifyMemoryWrite(const Object* obj, const Uint32 address, const Uint8 oldValue, const Uint8 newValue) {
+    for (auto* listener : changeListeners) {
+        listener->onMemoryWrite(obj, address, oldValue, newValue);
+    }
+}
+
+inline void advanceTime() {
+    simTime++;
+    for (auto* listener : changeListeners) {
+        listener->onTimeAdvance();
+    }
+}
+
+// Unique, human readable name of an object, e.g. "AND_12", for traces and reports. The number is the
+// id of the object, so names survive the deletion of other objects and are never given out twice.
+std::string objectName(const Object* obj);
+
+/**
+ * @brief Processes queued events until the circuit settles or the step limit is reached.
+ * @param maxSteps Maximum number of events to process.
+ * @return The number of events processed.
+ */
+int propagate(int maxSteps);
+
 #endif //SIMULATOR_HPP
@@ -0,0 +1,197 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "SpatialIndex.hpp"
+#include "Simulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+static int cellOf(const float coordinate) {
+    return static_cast<int>(std::floor(coordinate / SpatialIndex::CELL_SIZE));
+}
+
+void SpatialIndex::add(const Object* obj) {
+    order.push_back(obj->handle);
+    markDirty(obj);
+}
+
+void SpatialIndex::markDirty(const Object* obj) {
+    const Uint32 slot = obj->handle.slot;
+    if (slot >= entries.size()) entries.resize(slot + 1);
+    if (entries[slot].dirty) return;
+    entries[slot].dirty = true;
+    dirty.push_back(obj->handle);
+}
+
+void SpatialIndex::remove(const Object* obj) {
+    const Uint32 slot = obj->handle.slot;
+    if (slot >= entries.size()) return;
+    erase(slot);
+    // A pending refresh of the object finds its handle stale and skips it
+    entries[slot].dirty = false;
+    removed++;
+}
+
+void SpatialIndex::clear() {
+    cells.clear();
+    listed = 0;
+    entries.clear();
+    dirty.clear();
+    seen.clear();
+    order.clear();
+    removed = 0;
+}
+
+void SpatialIndex::erase(const Uint32 slot) {
+    Entry& entry = entries[slot];
+    for (const Uint64 key : entry.cells) {
+        const auto cell = cells.find(key);
+        if (cell == cells.end()) continue;
+        auto& slots = cell->second;
+        const auto it = std::ranges::find(slots, slot);
+        if (it != slots.end()) {
+            *it = slots.back();
+            slots.pop_back();
+            listed--;
+        }
+        if (slots.empty()) cells.erase(cell);
+    }
+    entry.cells.clear();
+}
+
+void SpatialIndex::insert(const Uint32 slot, const Object* obj) {
+    Entry& entry = entries[slot];
+    entry.handle = obj->handle;
+    // Loose ends of wires being drawn are never hit, and unconnected wires have no extent
+    const SDL_FRect bounds = obj->bounds();
+    if (obj->kind == KIND_FAKE || bounds.w < 0.0f || bounds.h < 0.0f) return;
+
+    entry.bounds = bounds;
+    SDL_FPoint start, end;
+    if (obj->kind == KIND_WIRE && static_cast<const Wire*>(obj)->endpoints(start, end)) {
+        insertSegment(entry, slot, start, end);
+        return;
+    }
+    for (int x = cellOf(entry.bounds.x); x <= cellOf(entry.bounds.x + entry.bounds.w); ++x) {
+        for (int y = cellOf(entry.bounds.y); y <= cellOf(entry.bounds.y + entry.bounds.h); ++y) {
+            entry.cells.push_back(cellKey(x, y));
+            cells[entry.cells.back()].push_back(slot);
+            listed++;
+        }
+    }
+}
+
+// A long diagonal wire would fill its whole bounding box with cells, so it is only listed in the
+// cells its segment passes through: column by column, the rows between the
+// heights of the segment at the edges of the column.
+void SpatialIndex::insertSegment(Entry& entry, const Uint32 slot, SDL_FPoint start, SDL_FPoint end) {
+    if (start.x > end.x) std::swap(start, end);
+    const float slope = end.x > start.x ? (end.y - start.y) / (end.x - start.x) : 0.0f;
+    for (int x = cellOf(start.x); x <= cellOf(end.x); ++x) {
+        float top = std::min(start.y, end.y), bottom = std::max(start.y, end.y);
+        if (end.x > start.x) {
+            const float left = std::max(start.x, x * CELL_SIZE);
+            const float right = std::min(end.x, (x + 1) * CELL_SIZE);
+            top = start.y + (left - start.x) * slope;
+            bottom = start.y + (right - start.x) * slope;
+            if (top > bottom) std::swap(top, bottom);
+        }
+        for (int y = cellOf(top); y <= cellOf(bottom); ++y) {
+            entry.cells.push_back(cellKey(x, y));
+            cells[entry.cells.back()].push_back(slot);
+            listed++;
+        }
+    }
+}
+
+void SpatialIndex::refresh() {
+    for (const ObjectHandle handle : dirty) {
+        const Object* obj = objectSlots.get(handle);
+        if (!obj || !entries[handle.slot].dirty) continue;
+        entries[handle.slot].dirty = false;
+        erase(handle.slot);
+        insert(handle.slot, obj);
+    }
+    dirty.clear();
+}
+
+std::vector<Object*> SpatialIndex::query(const SDL_FRect& area) {
+    refresh();
+    if (removed > order.size() / 2) {
+        std::erase_if(order, [](const ObjectHandle handle) { return !objectSlots.get(handle); });
+        removed = 0;
+    }
+    const auto overlaps = [&](const Entry& entry) {
+        return entry.bounds.x <= area.x + area.w && entry.bounds.x + entry.bounds.w >= area.x &&
+               entry.bounds.y <= area.y + area.h && entry.bounds.y + entry.bounds.h >= area.y;
+    };
+
+    std::vector<Object*> found;
+    const int x0 = cellOf(area.x), x1 = cellOf(area.x + area.w);
+    const int y0 = cellOf(area.y), y1 = cellOf(area.y + area.h);
+    // Walking the cells costs a few cache misses per object found, while testing every object is a
+    // quick linear pass that lists them in drawing order without sorting. The latter wins when the
+    // cells in the area, at the average occupancy, hold more than a quarter of all objects.
+    const double covered = static_cast<double>(x1 - x0 + 1) * (y1 - y0 + 1);
+    if (covered >= static_cast<double>(cells.size()) ||
+        covered * static_cast<double>(listed) / static_cast<double>(cells.size()) > static_cast<double>(objects.size()) / 4) {
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            const Entry& entry = entries[it->slot];
+            if (entry.cells.empty() || !overlaps(entry)) continue;
+            if (Object* obj = objectSlots.get(*it)) found.push_back(obj);
+        }
+        return found;
+    }
+
+    if (seen.size() < entries.size()) seen.resize(entries.size(), 0);
+    if (++stamp == 0) {
+        std::ranges::fill(seen, 0);
+        stamp = 1;
+    }
+    // Paired with their id, so that sorting doesn't go back to the objects for it
+    std::vector<std::pair<Uint64, Object*>> hits;
+    for (int x = x0; x <= x1; ++x) {
+        for (int y = y0; y <= y1; ++y) {
+            const auto cell = cells.find(cellKey(x, y));
+            if (cell == cells.end()) continue;
+            for (const Uint32 slot : cell->second) {
+                if (seen[slot] == stamp) continue;
+                seen[slot] = stamp;
+                if (!overlaps(entries[slot])) continue;
+                if (Object* obj = objectSlots.get(entries[slot].handle)) hits.emplace_back(obj->id, obj);
+            }
+        }
+    }
+    std::ranges::sort(hits, std::greater{});
+    found.reserve(hits.size());
+    for (const auto& [id, obj] : hits) found.push_back(obj);
+    return found;
+}
+
+std::vector<SpatialIndex::Cell> SpatialIndex::occupiedCells(const SDL_FRect& area) {
+    refresh();
+    std::vector<Cell> found;
+    const int x0 = cellOf(area.x), x1 = cellOf(area.x + area.w);
+    const int y0 = cellOf(area.y), y1 = cellOf(area.y + area.h);
+    const auto add = [&](const int x, const int y, const size_t count) {
+        found.push_back({{x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE}, count});
+    };
+    if (static_cast<double>(x1 - x0 + 1) * (y1 - y0 + 1) > static_cast<double>(cells.size())) {
+        for (const auto& [key, slots] : cells) {
+            const int x = static_cast<Sint32>(key >> 32), y = static_cast<Sint32>(key & 0xffffffff);
+            if (x >= x0 && x <= x1 && y >= y0 && y <= y1) add(x, y, slots.size());
+        }
+    } else {
+        for (int x = x0; x <= x1; ++x) {
+            for (int y = y0; y <= y1; ++y) {
+                const auto cell = cells.find(cellKey(x, y));
+                if (cell != cells.end()) add(x, y, cell->second.size());
+            }
+        }
+    }
+    return found;
+}
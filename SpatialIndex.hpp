@@ -0,0 +1,69 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef SPATIALINDEX_HPP
+#define SPATIALINDEX_HPP
+
+#include <SDL3/SDL.h>
+#include <unordered_map>
+#include <vector>
+
+#include "ObjectSlots.hpp"
+
+class Object;
+
+// Uniform grid over the bounds of the objects in the canvas, so that clicks, pin snapping and box
+// selection only look at the objects near the mouse. Objects report themselves as dirty when they
+// move, resize or are reconnected, and are re-inserted lazily before the next query.
+class SpatialIndex {
+public:
+    static constexpr float CELL_SIZE = 128.0f;
+
+    // Lists a new object, on top of all the others
+    void add(const Object* obj);
+    void markDirty(const Object* obj);
+    void remove(const Object* obj);
+    // Objects whose bounds overlap the area, topmost (last drawn) first. Wires are only listed along
+    // their segment rather than over all of their bounding box, so callers still test the objects
+    // themselves. Hit tests grow the area by their tolerance, which depends on the zoom.
+    std::vector<Object*> query(const SDL_FRect& area);
+
+    struct Cell {
+        SDL_FRect rect;
+        size_t count; // Objects listed in the cell
+    };
+    // Occupied cells overlapping the area, to draw an overview of the canvas when single objects
+    // would be too small to make out
+    std::vector<Cell> occupiedCells(const SDL_FRect& area);
+    void clear();
+
+private:
+    struct Entry {
+        ObjectHandle handle;
+        SDL_FRect bounds{};
+        std::vector<Uint64> cells; // Keys of the cells the object is listed in
+        bool dirty = false;
+    };
+
+    void refresh();
+    void insert(Uint32 slot, const Object* obj);
+    void insertSegment(Entry& entry, Uint32 slot, SDL_FPoint start, SDL_FPoint end);
+    void erase(Uint32 slot);
+    static Uint64 cellKey(int x, int y) { return static_cast<Uint64>(static_cast<Uint32>(x)) << 32 | static_cast<Uint32>(y); }
+
+    std::unordered_map<Uint64, std::vector<Uint32>> cells; // Slots of the objects overlapping each cell
+    size_t listed = 0; // Slots in all cells together
+    std::vector<Entry> entries; // By handle slot
+    // Every object in drawing order, which is creation order. Deleting objects reorders the objects
+    // vector, so the order is kept here; deleted objects are swept out once they make up half.
+    std::vector<ObjectHandle> order;
+    size_t removed = 0;
+    std::vector<ObjectHandle> dirty;
+    std::vector<Uint32> seen; // Query stamp per slot, to report objects spanning several cells once
+    Uint32 stamp = 0;
+};
+
+extern SpatialIndex spatialIndex;
+
+#endif //SPATIALINDEX_HPP
@@ -0,0 +1,69 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "SpriteBatch.hpp"
+
+void SpriteBatch::add(SDL_Renderer* renderer, const Sprite& sprite, const SDL_FRect& dest) {
+    if (!sprite.texture) return;
+    quad(renderer, sprite.texture, sprite.source, dest, {1.0f, 1.0f, 1.0f, 1.0f});
+}
+
+void SpriteBatch::fill(SDL_Renderer* renderer, const SDL_FRect& dest, const SDL_FColor color) {
+    const Sprite white = textureCache.white(renderer);
+    if (white.texture) {
+        quad(renderer, white.texture, white.source, dest, color);
+        return;
+    }
+
+    // Without an atlas there is nothing to batch with
+    SDL_SetRenderDrawColorFloat(renderer, color.r, color.g, color.b, color.a);
+    SDL_RenderFillRect(renderer, &dest);
+}
+
+void SpriteBatch::text(const float x, const float y, const char* label) {
+    labels.push_back({{x, y}, label});
+}
+
+void SpriteBatch::quad(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_FRect& source, const SDL_FRect& dest,
+                       const SDL_FColor color) {
+    // Everything comes from the one atlas, so this only happens if there are several renderers
+    if (texture != this->texture) {
+        flush(renderer);
+        this->texture = texture;
+    }
+
+    float atlasW, atlasH;
+    SDL_GetTextureSize(texture, &atlasW, &atlasH);
+    const float u0 = source.x / atlasW;
+    const float v0 = source.y / atlasH;
+    const float u1 = (source.x + source.w) / atlasW;
+    const float v1 = (source.y + source.h) / atlasH;
+
+    const int first = static_cast<int>(vertices.size());
+    vertices.push_back({{dest.x, dest.y}, color, {u0, v0}});
+    vertices.push_back({{dest.x + dest.w, dest.y}, color, {u1, v0}});
+    vertices.push_back({{dest.x + dest.w, dest.y + dest.h}, color, {u1, v1}});
+    vertices.push_back({{dest.x, dest.y + dest.h}, color, {u0, v1}});
+    for (const int corner : {0, 1, 2, 0, 2, 3}) {
+        indices.push_back(first + corner);
+    }
+}
+
+void SpriteBatch::flush(SDL_Renderer* renderer) {
+    if (!vertices.empty()) {
+        SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+    }
+    // Keeps the capacity, so a steady frame doesn't allocate
+    vertices.clear();
+    indices.clear();
+
+    if (labels.empty()) return;
+    SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
+    for (const auto& label : labels) {
+        SDL_RenderDebugText(renderer, label.at.x, label.at.y, label.text.c_str());
+    }
+    labels.clear();
+}
@@ -0,0 +1,41 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef SPRITEBATCH_HPP
+#define SPRITEBATCH_HPP
+
+#include <SDL3/SDL.h>
+#include <string>
+#include <vector>
+
+#include "TextureCache.hpp"
+
+// Collects the quads of a frame that come from the atlas and draws them all with one
+// SDL_RenderGeometry call, in the order they were added. Solid rectangles are drawn with the
+// atlas' white texels, so selection highlights stay in the same call as the sprites. Text labels
+// can't come from the atlas; they are drawn on top once the quads are out.
+class SpriteBatch {
+public:
+    void add(SDL_Renderer* renderer, const Sprite& sprite, const SDL_FRect& dest);
+    void fill(SDL_Renderer* renderer, const SDL_FRect& dest, SDL_FColor color);
+    void text(float x, float y, const char* label);
+    void flush(SDL_Renderer* renderer);
+
+private:
+    struct Label {
+        SDL_FPoint at;
+        std::string text;
+    };
+
+    void quad(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_FRect& source, const SDL_FRect& dest, SDL_FColor color);
+
+    SDL_Texture* texture = nullptr;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    std::vector<Label> labels;
+};
+
+extern SpriteBatch spriteBatch;
+
+#endif //SPRITEBATCH_HPP
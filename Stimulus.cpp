@@ -0,0 +1,358 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Stimulus.hpp"
+#include "Simulator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+static constexpr char STIMULUS_MAGIC[4] = {'L', 'S', 'S', 'B'};
+static constexpr Uint16 STIMULUS_FORMAT = 1;
+
+template<typename T>
+static void put(std::vector<char>& out, const T value) {
+    const auto* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static T get(const Uint8* in) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    return value;
+}
+
+static size_t packedSize(const size_t bits) {
+    return (bits + 7) / 8;
+}
+
+StimulusReader::~StimulusReader() {
+    close();
+}
+
+bool StimulusReader::open(const char* path) {
+    close();
+    file = SDL_IOFromFile(path, "rb");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to open %s: %s", path, SDL_GetError());
+        return false;
+    }
+    buffer.resize(CHUNK_SIZE);
+    pos = end = 0;
+    eof = error = false;
+    line = 0;
+    inputNames.clear();
+    outputNames.clear();
+    pendingRow.clear();
+
+    binary = fill(sizeof(STIMULUS_MAGIC)) && std::memcmp(buffer.data(), STIMULUS_MAGIC, sizeof(STIMULUS_MAGIC)) == 0;
+    if (!(binary ? readBinaryHeader() : readHeader())) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "%s is not a stimulus file.", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void StimulusReader::close() {
+    if (file) SDL_CloseIO(file);
+    file = nullptr;
+}
+
+// Makes sure at least `needed` unread bytes are buffered, unless the file ends first
+bool StimulusReader::fill(const size_t needed) {
+    while (end - pos < needed && !eof) {
+        // Keep the unread tail, then append the next chunk
+        if (pos > 0) {
+            std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+            end -= pos;
+            pos = 0;
+        }
+        if (buffer.size() - end < CHUNK_SIZE) buffer.resize(std::max(buffer.size() * 2, end + CHUNK_SIZE));
+        const size_t read = SDL_ReadIO(file, buffer.data() + end, buffer.size() - end);
+        if (read == 0) eof = true;
+        end += read;
+    }
+    return end - pos >= needed;
+}
+
+bool StimulusReader::readLine(std::string_view& text) {
+    while (true) {
+        size_t scanned = 0;
+        const char* newline;
+        while (!(newline = static_cast<const char*>(std::memchr(buffer.data() + pos + scanned, '\n', end - pos - scanned)))) {
+            if (eof) break;
+            scanned = end - pos;
+            fill(scanned + 1);
+        }
+        if (!newline && pos == end) return false;
+
+        const size_t lineEnd = newline ? newline - buffer.data() : end;
+        text = std::string_view(buffer.data() + pos, lineEnd - pos);
+        pos = newline ? lineEnd + 1 : end;
+        line++;
+
+        if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+        if (text.empty() || text.front() == '#') continue;
+        return true;
+    }
+}
+
+bool StimulusReader::readBytes(const size_t size, const Uint8*& bytes) {
+    if (!fill(size)) return false;
+    bytes = reinterpret_cast<const Uint8*>(buffer.data() + pos);
+    pos += size;
+    return true;
+}
+
+static std::vector<std::string> splitNames(std::string_view text) {
+    std::vector<std::string> names;
+    while (!text.empty()) {
+        const size_t start = text.find_first_not_of(" \t");
+        if (start == std::string_view::npos) break;
+        text.remove_prefix(start);
+        const size_t length = std::min(text.find_first_of(" \t"), text.size());
+        names.emplace_back(text.substr(0, length));
+        text.remove_prefix(length);
+    }
+    return names;
+}
+
+bool StimulusReader::readHeader() {
+    std::string_view text;
+    if (!readLine(text) || !text.starts_with("inputs")) return false;
+    inputNames = splitNames(text.substr(6));
+
+    // The outputs line is optional. If the next line is a row already, keep it for next().
+    if (readLine(text)) {
+        if (text.starts_with("outputs")) outputNames = splitNames(text.substr(7));
+        else pendingRow = text;
+    }
+    return true;
+}
+
+bool StimulusReader::readBinaryHeader() {
+    const Uint8* bytes;
+    if (!readBytes(16, bytes)) return false;
+    if (get<Uint16>(bytes + 4) != STIMULUS_FORMAT) return false;
+    const Uint32 inputs = get<Uint32>(bytes + 8);
+    const Uint32 outputs = get<Uint32>(bytes + 12);
+
+    for (Uint32 i = 0; i < inputs + outputs; ++i) {
+        if (!readBytes(2, bytes)) return false;
+        const Uint16 length = get<Uint16>(bytes);
+        if (!readBytes(length, bytes)) return false;
+        (i < inputs ? inputNames : outputNames).emplace_back(reinterpret_cast<const char*>(bytes), length);
+    }
+    return true;
+}
+
+static bool parseValues(std::string_view text, std::vector<Uint8>& values) {
+    if (text.size() != values.size()) return false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        switch (text[i]) {
+            case '0': values[i] = 0; break;
+            case '1': values[i] = 1; break;
+            case 'x':
+            case 'X': values[i] = STIMULUS_X; break;
+            default: return false;
+        }
+    }
+    return true;
+}
+
+bool StimulusReader::next(std::vector<Uint8>& inputs, std::vector<Uint8>& expected) {
+    inputs.resize(inputNames.size());
+    expected.resize(outputNames.size());
+
+    if (binary) {
+        const size_t inputBytes = packedSize(inputs.size()), outputBytes = packedSize(expected.size());
+        const Uint8* row;
+        if (inputBytes + outputBytes == 0 || !readBytes(inputBytes + 2 * outputBytes, row)) return false;
+        for (size_t i = 0; i < inputs.size(); ++i) inputs[i] = (row[i / 8] >> (i % 8)) & 1;
+        const Uint8* values = row + inputBytes;
+        const Uint8* mask = values + outputBytes;
+        for (size_t o = 0; o < expected.size(); ++o) {
+            expected[o] = (mask[o / 8] >> (o % 8)) & 1 ? (values[o / 8] >> (o % 8)) & 1 : STIMULUS_X;
+        }
+        return true;
+    }
+
+    std::string_view text;
+    if (!pendingRow.empty()) {
+        text = pendingRow;
+    } else if (!readLine(text)) {
+        return false;
+    }
+    const size_t split = text.find(' ');
+    const std::string_view in = text.substr(0, split);
+    const std::string_view out = split == std::string_view::npos ? std::string_view() : text.substr(split + 1);
+    if (!parseValues(in, inputs) || !parseValues(out, expected)) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Malformed stimulus on line %llu.", static_cast<unsigned long long>(line));
+        error = true;
+        return false;
+    }
+    pendingRow.clear();
+    return true;
+}
+
+
+StimulusWriter::~StimulusWriter() {
+    close();
+}
+
+bool StimulusWriter::open(const char* path, const std::vector<std::string>& inputs,
+                          const std::vector<std::string>& outputs, const bool binary) {
+    close();
+    file = SDL_IOFromFile(path, binary ? "wb" : "w");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create %s: %s", path, SDL_GetError());
+        return false;
+    }
+    this->binary = binary;
+
+    row.clear();
+    if (binary) {
+        row.insert(row.end(), std::begin(STIMULUS_MAGIC), std::end(STIMULUS_MAGIC));
+        put(row, STIMULUS_FORMAT);
+        put(row, Uint16{0});
+        put(row, static_cast<Uint32>(inputs.size()));
+        put(row, static_cast<Uint32>(outputs.size()));
+        for (const auto* names : {&inputs, &outputs}) {
+            for (const auto& name : *names) {
+                put(row, static_cast<Uint16>(name.size()));
+                row.insert(row.end(), name.begin(), name.end());
+            }
+        }
+    } else {
+        const auto names = [this](const char* label, const std::vector<std::string>& list) {
+            row.insert(row.end(), label, label + std::strlen(label));
+            for (const auto& name : list) {
+                row.push_back(' ');
+                row.insert(row.end(), name.begin(), name.end());
+            }
+            row.push_back('\n');
+        };
+        names("inputs", inputs);
+        names("outputs", outputs);
+    }
+    SDL_WriteIO(file, row.data(), row.size());
+    return true;
+}
+
+void StimulusWriter::write(const std::vector<bool>& inputs, const std::vector<bool>& expected) {
+    if (!file) return;
+    row.clear();
+    if (binary) {
+        const size_t inputBytes = packedSize(inputs.size()), outputBytes = packedSize(expected.size());
+        row.assign(inputBytes + 2 * outputBytes, 0);
+        for (size_t i = 0; i < inputs.size(); ++i) row[i / 8] |= static_cast<char>(inputs[i] << (i % 8));
+        for (size_t o = 0; o < expected.size(); ++o) {
+            row[inputBytes + o / 8] |= static_cast<char>(expected[o] << (o % 8));
+            row[inputBytes + outputBytes + o / 8] |= static_cast<char>(1 << (o % 8));
+        }
+    } else {
+        for (const bool value : inputs) row.push_back(value ? '1' : '0');
+        row.push_back(' ');
+        for (const bool value : expected) row.push_back(value ? '1' : '0');
+        row.push_back('\n');
+    }
+    SDL_WriteIO(file, row.data(), row.size());
+}
+
+void StimulusWriter::close() {
+    if (file) SDL_CloseIO(file);
+    file = nullptr;
+}
+
+
+StimulusRunner::StimulusRunner(const CompiledCircuit& circuit) : circuit(circuit), instance(circuit) {}
+
+bool StimulusRunner::run(const char* path) {
+    StimulusReader reader;
+    if (!reader.open(path)) return false;
+
+    std::unordered_map<std::string, Uint32> nodes;
+    for (Uint32 i = 0; i < circuit.netlist.nodes.size(); ++i) nodes[objectName(circuit.netlist.nodes[i])] = i;
+
+    // Resolve the columns once, so rows only index into the instance
+    struct Drive {
+        Uint32 node;
+        Sint32 bit; // Output bit of a memory, or -1 for the state of the node
+    };
+    std::vector<Drive> drives;
+    for (const auto& name : reader.inputNames) {
+        const size_t bracket = name.ends_with(']') ? name.rfind('[') : std::string::npos;
+        const auto it = nodes.find(bracket == std::string::npos ? name : name.substr(0, bracket));
+        if (it == nodes.end()) {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Stimulus input %s is not in the circuit.", name.c_str());
+            return false;
+        }
+        const auto kind = circuit.kind[it->second];
+        const bool memory = kind == CompiledCircuit::RAM || kind == CompiledCircuit::ROM;
+        const bool state = kind == CompiledCircuit::BUTTON || kind == CompiledCircuit::CLOCK || kind == CompiledCircuit::FLIPFLOP;
+        const Sint32 bit = bracket == std::string::npos ? (memory ? 0 : -1) : std::atoi(name.c_str() + bracket + 1);
+        if (memory ? bit < 0 || bit >= Ram::DATA_BITS : !state || bit >= 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Stimulus input %s cannot be driven.", name.c_str());
+            return false;
+        }
+        drives.push_back({it->second, bit});
+    }
+
+    struct Probe {
+        Uint32 node;
+        Sint32 pin; // -1 for the state of the node
+    };
+    std::vector<Probe> probes;
+    for (const auto& name : reader.outputNames) {
+        const size_t dot = name.rfind(".in");
+        const auto it = nodes.find(dot == std::string::npos ? name : name.substr(0, dot));
+        Sint32 pin = dot == std::string::npos ? -1 : std::atoi(name.c_str() + dot + 3);
+        if (it == nodes.end() || pin >= static_cast<Sint32>(circuit.netlist.nodes[it->second]->inputPins.size())) {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Stimulus output %s is not in the circuit.", name.c_str());
+            return false;
+        }
+        probes.push_back({it->second, pin});
+    }
+
+    const bool clocked = !circuit.netlist.clocks.empty() || !circuit.netlist.sequential.empty();
+    const Uint64 start = SDL_GetTicks();
+    rows = mismatchCount = 0;
+    mismatches.clear();
+    instance.reset();
+
+    std::vector<Uint8> inputs, expected;
+    while (reader.next(inputs, expected)) {
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if (inputs[i] == STIMULUS_X) continue;
+            const Drive& drive = drives[i];
+            if (drive.bit < 0) instance.force(drive.node, inputs[i]);
+            else instance.forceWord(drive.node, drive.bit, inputs[i]);
+        }
+        instance.settle();
+
+        for (size_t o = 0; o < expected.size(); ++o) {
+            if (expected[o] == STIMULUS_X) continue;
+            const Probe& probe = probes[o];
+            const bool actual = probe.pin < 0 ? instance.value(probe.node) : instance.pinValue(probe.node, probe.pin);
+            if (actual == static_cast<bool>(expected[o])) continue;
+            if (mismatches.size() < MAX_REPORTED) mismatches.push_back({rows, reader.outputNames[o], static_cast<bool>(expected[o])});
+            mismatchCount++;
+        }
+        if (clocked) instance.cycle();
+        rows++;
+    }
+
+    SDL_Log("Replayed %llu rows of %s in %llu ms: %llu mismatches.", static_cast<unsigned long long>(rows), path,
+        static_cast<unsigned long long>(SDL_GetTicks() - start), static_cast<unsigned long long>(mismatchCount));
+    for (const auto& mismatch : mismatches) {
+        SDL_Log("  time %llu: %s is %d, expected %d", static_cast<unsigned long long>(mismatch.time),
+            mismatch.net.c_str(), !mismatch.expected, mismatch.expected);
+    }
+    return !reader.failed();
+}
@@ -0,0 +1,108 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef STIMULUS_HPP
+#define STIMULUS_HPP
+
+#include <SDL3/SDL.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CompiledCircuit.hpp"
+
+// Stimulus files hold one row of input values and expected output values per time step.
+//
+// Text: a line "inputs <name>..." and optionally a line "outputs <name>...", then one line per
+// row with the input values, a space and the expected values, as strings of 0, 1 and x. An x input
+// keeps its previous value, an x output is not checked. Lines starting with # are comments.
+//
+// Binary: "LSSB", u16 format, u16 reserved, u32 input count, u32 output count, every name as u16
+// length and bytes, then fixed-size rows: input bits, expected output bits and a mask of the
+// outputs to check, each packed LSB first and padded to whole bytes.
+
+static constexpr Uint8 STIMULUS_X = 2;
+
+class StimulusReader {
+public:
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+    bool binary = false;
+
+    ~StimulusReader();
+
+    bool open(const char* path);
+    void close();
+    /**
+     * @brief Reads the next row.
+     * @param inputs Receives 0, 1 or STIMULUS_X per input.
+     * @param expected Receives 0, 1 or STIMULUS_X per output.
+     * @return false at the end of the file or on a malformed row, see error.
+     */
+    bool next(std::vector<Uint8>& inputs, std::vector<Uint8>& expected);
+    bool failed() const { return error; }
+
+private:
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+    SDL_IOStream* file = nullptr;
+    std::vector<char> buffer;
+    size_t pos = 0, end = 0;
+    bool eof = false;
+    bool error = false;
+    Uint64 line = 0;
+    std::string pendingRow; // First row, read while looking for the outputs line
+
+    bool fill(size_t needed);
+    bool readLine(std::string_view& text);
+    bool readBytes(size_t size, const Uint8*& bytes);
+    bool readHeader();
+    bool readBinaryHeader();
+};
+
+class StimulusWriter {
+public:
+    ~StimulusWriter();
+
+    bool open(const char* path, const std::vector<std::string>& inputs, const std::vector<std::string>& outputs,
+              bool binary);
+    void write(const std::vector<bool>& inputs, const std::vector<bool>& expected);
+    void close();
+
+private:
+    SDL_IOStream* file = nullptr;
+    bool binary = false;
+    std::vector<char> row;
+};
+
+// Replays a stimulus file on a CircuitInstance. For every row the inputs are applied and the logic
+// is settled, then the outputs are compared with the expected values and, if the circuit is
+// clocked, one clock cycle is simulated.
+// Inputs can name any object whose state can be forced (buttons, clocks, flip-flops), or output bit N
+// of a memory as "<name>[N]", which then holds its value like a scanned-in register. Outputs can name
+// any object, or input pin N of an object as "<name>.in<N>". Both follow CombinationalModel.
+class StimulusRunner {
+public:
+    struct Mismatch {
+        Uint64 time; // Row of the file
+        std::string net;
+        bool expected;
+    };
+
+    static constexpr size_t MAX_REPORTED = 100;
+
+    Uint64 rows = 0;
+    Uint64 mismatchCount = 0;
+    std::vector<Mismatch> mismatches; // The first MAX_REPORTED mismatches
+
+    explicit StimulusRunner(const CompiledCircuit& circuit);
+
+    bool run(const char* path);
+
+private:
+    const CompiledCircuit& circuit;
+    CircuitInstance instance;
+};
+
+#endif //STIMULUS_HPP
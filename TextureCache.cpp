@@ -0,0 +1,71 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "TextureCache.hpp"
+#include "AtlasIndex.hpp"
+#include "MappedFile.hpp"
+#include "Camera.hpp"
+
+#include <iterator>
+#include <string>
+
+static_assert(std::size(ATLAS_ENTRIES) == ASSET_COUNT, "atlas.rgba was built from a different list of images");
+// Components are drawn at 0.05 of their image size. Zoomed all the way in, a texel must not cover
+// more than a pixel, or the sprites blur.
+static_assert(0.05f * Camera::MAX_ZOOM * ATLAS_DOWNSCALE <= 1.0f, "ATLAS_DOWNSCALE is too coarse for Camera::MAX_ZOOM");
+
+static SDL_Texture* loadAtlas(SDL_Renderer* renderer) {
+    // The atlas is written next to the executable by the build
+    const char* base = SDL_GetBasePath();
+    const std::string path = std::string(base ? base : "") + "atlas.rgba";
+    MappedFile file;
+    if (!file.open(path.c_str())) return nullptr;
+
+    const size_t pitch = static_cast<size_t>(ATLAS_WIDTH) * 4;
+    if (file.size() != pitch * ATLAS_HEIGHT) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "%s doesn't match AtlasIndex.hpp, rebuild the assets.", path.c_str());
+        return nullptr;
+    }
+
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                             ATLAS_WIDTH, ATLAS_HEIGHT);
+    if (!texture || !SDL_UpdateTexture(texture, nullptr, file.data(), static_cast<int>(pitch))) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load texture: %s", SDL_GetError());
+        if (texture) SDL_DestroyTexture(texture);
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_LINEAR);
+    return texture;
+}
+
+SDL_Texture* TextureCache::atlas(SDL_Renderer* renderer) {
+    // Without a renderer, e.g. in batch runs, there is nothing to upload to
+    if (!renderer) return nullptr;
+
+    for (const auto& entry : entries) {
+        if (entry.renderer == renderer) return entry.texture;
+    }
+    // Also remembered if loading failed, so it isn't retried for every object
+    return entries.emplace_back(Entry{renderer, loadAtlas(renderer)}).texture;
+}
+
+Sprite TextureCache::get(SDL_Renderer* renderer, const Asset asset) {
+    if (asset >= ASSET_COUNT) return {};
+    const auto& entry = ATLAS_ENTRIES[asset];
+    return {atlas(renderer), {entry.x, entry.y, entry.w, entry.h}, entry.width, entry.height};
+}
+
+Sprite TextureCache::white(SDL_Renderer* renderer) {
+    return {atlas(renderer), {ATLAS_WHITE.x, ATLAS_WHITE.y, ATLAS_WHITE.w, ATLAS_WHITE.h}, ATLAS_WHITE.width,
+            ATLAS_WHITE.height};
+}
+
+void TextureCache::clear() {
+    for (const auto& entry : entries) {
+        if (entry.texture) SDL_DestroyTexture(entry.texture);
+    }
+    entries.clear();
+}
@@ -0,0 +1,47 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef TEXTURECACHE_HPP
+#define TEXTURECACHE_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+// Component images, packed into atlas.rgba at build time from Assets/*.png. The gates come first,
+// in GateType order. CMakeLists.txt passes the images to AtlasBuilder in this order.
+enum Asset {
+    ASSET_BUF, ASSET_NOT, ASSET_AND, ASSET_OR, ASSET_NAND, ASSET_NOR, ASSET_XOR, ASSET_XNOR,
+    ASSET_BUTTON0, ASSET_BUTTON1, ASSET_CLOCK, ASSET_LED0, ASSET_LED1,
+    ASSET_COUNT
+};
+
+// A component image: where it is in the atlas, and the size objects lay out their pins in
+struct Sprite {
+    SDL_Texture* texture = nullptr; // The atlas, nullptr without a renderer
+    SDL_FRect source{}; // In atlas pixels
+    float w = 0.0f, h = 0.0f; // Of the original image
+};
+
+// Uploads the pre-decoded atlas once per renderer, on first use, and hands out sprites into it.
+// The textures belong to the cache: objects must not destroy them.
+class TextureCache {
+public:
+    Sprite get(SDL_Renderer* renderer, Asset asset);
+    // Opaque white texels, to draw solid rectangles from the atlas
+    Sprite white(SDL_Renderer* renderer);
+    SDL_Texture* atlas(SDL_Renderer* renderer);
+    // Destroys all textures, e.g. before their renderer goes away
+    void clear();
+
+private:
+    struct Entry {
+        SDL_Renderer* renderer;
+        SDL_Texture* texture = nullptr;
+    };
+    std::vector<Entry> entries;
+};
+
+extern TextureCache textureCache;
+
+#endif //TEXTURECACHE_HPP
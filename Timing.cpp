@@ -0,0 +1,149 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Timing.hpp"
+#include "Netlist.hpp"
+#include "Camera.hpp"
+
+#include <algorithm>
+
+void TimingAnalysis::analyze(const Netlist& netlist, const DelayModel& model, const size_t topPaths) {
+    const auto n = static_cast<Uint32>(netlist.nodes.size());
+    arrival.assign(n, 0.0f);
+    predecessor.assign(n, NO_NODE);
+    paths.clear();
+    criticalObjects.clear();
+    version = netlist.version;
+
+    // Delay through every node, and the pins that are timing endpoints
+    std::vector<float> delay(n, 0.0f);
+    std::vector<Uint32> endpoints;
+    std::vector<Uint8> clockPin(n, 0xff); // Clock or enable pin of a flip-flop, which isn't timed as data
+    for (Uint32 i = 0; i < n; ++i) {
+        Object* obj = netlist.nodes[i];
+        switch (obj->kind) {
+            case KIND_GATE: delay[i] = model.gateDelay[static_cast<const Gate*>(obj)->type]; break;
+            case KIND_WIRE: delay[i] = model.wireDelay; break;
+            case KIND_RAM:
+            case KIND_ROM: delay[i] = model.memoryDelay; break;
+            case KIND_FLIPFLOP: {
+                const auto type = static_cast<const FlipFlop*>(obj)->type;
+                arrival[i] = model.clockToQ;
+                if (type == DFF || type == TFF || type == D_LATCH) clockPin[i] = 1;
+                else if (type == JKFF) clockPin[i] = 2;
+                endpoints.push_back(i);
+                break;
+            }
+            case KIND_LED: endpoints.push_back(i); break;
+            default: break;
+        }
+    }
+
+    // Longest path in topological order. Nodes on combinational loops come last and are only
+    // visited once, so their arrival times are a lower bound.
+    for (const Uint32 node : netlist.order) {
+        float latest = 0.0f;
+        Uint32 from = NO_NODE;
+        for (Uint32 e = netlist.faninStart[netlist.pinStart[node]]; e < netlist.faninStart[netlist.pinStart[node + 1]]; ++e) {
+            const Uint32 driver = netlist.fanin[e];
+            if (from == NO_NODE || arrival[driver] > latest) {
+                latest = arrival[driver];
+                from = driver;
+            }
+        }
+        arrival[node] = latest + delay[node];
+        predecessor[node] = from;
+    }
+    if (netlist.cyclic > 0) {
+        SDL_Log("Warning: arrival times on the %zu objects in combinational loops are underestimated.", netlist.cyclic);
+    }
+
+    // Required times at the endpoints. Flip-flops are judged by their latest data pin.
+    struct Endpoint {
+        float arrival;
+        Uint32 node;
+        Uint32 from;
+    };
+    std::vector<Endpoint> required;
+    required.reserve(endpoints.size());
+    for (const Uint32 node : endpoints) {
+        const bool sequential = netlist.nodes[node]->isSequential();
+        float latest = 0.0f;
+        Uint32 from = NO_NODE;
+        const Uint32 pins = netlist.pinStart[node];
+        for (Uint32 pin = pins; pin < netlist.pinStart[node + 1]; ++pin) {
+            if (pin - pins == clockPin[node]) continue;
+            for (Uint32 e = netlist.faninStart[pin]; e < netlist.faninStart[pin + 1]; ++e) {
+                if (from == NO_NODE || arrival[netlist.fanin[e]] > latest) {
+                    latest = arrival[netlist.fanin[e]];
+                    from = netlist.fanin[e];
+                }
+            }
+        }
+        if (from == NO_NODE) continue;
+        required.push_back({latest + (sequential ? model.setup : 0.0f), node, from});
+    }
+
+    const size_t count = std::min(topPaths, required.size());
+    std::partial_sort(required.begin(), required.begin() + static_cast<std::ptrdiff_t>(count), required.end(),
+                      [](const Endpoint& a, const Endpoint& b) { return a.arrival > b.arrival; });
+    for (size_t p = 0; p < count; ++p) {
+        Path path{required[p].arrival, model.clockPeriod - required[p].arrival, {required[p].node}};
+        // Bounded by the node count, in case a combinational loop made the chain circular
+        for (Uint32 node = required[p].from; node != NO_NODE && path.nodes.size() <= n; node = predecessor[node]) {
+            path.nodes.push_back(node);
+        }
+        std::ranges::reverse(path.nodes);
+        paths.push_back(std::move(path));
+    }
+
+    if (!paths.empty()) {
+        for (const Uint32 node : paths.front().nodes) criticalObjects.push_back(netlist.nodes[node]);
+    }
+}
+
+void TimingAnalysis::report(const Netlist& netlist) const {
+    if (paths.empty()) {
+        SDL_Log("Timing: no constrained paths.");
+        return;
+    }
+    SDL_Log("Timing: worst slack %.3f ns, critical path %.3f ns through %zu objects.", paths.front().slack,
+        paths.front().arrival, criticalObjects.size());
+    for (size_t p = 0; p < paths.size(); ++p) {
+        const auto& path = paths[p];
+        SDL_Log("  #%zu to %s: arrival %.3f ns, slack %.3f ns", p + 1,
+            objectName(netlist.nodes[path.nodes.back()]).c_str(), path.arrival, path.slack);
+    }
+    std::string chain;
+    const auto& critical = paths.front();
+    for (size_t i = 0; i < critical.nodes.size(); ++i) {
+        const Uint32 node = critical.nodes[i];
+        if (netlist.nodes[node]->kind == KIND_WIRE) continue;
+        // The endpoint is tagged with the time its data pin must settle by, not with its own output
+        const float time = i + 1 == critical.nodes.size() ? critical.arrival : arrival[node];
+        if (!chain.empty()) chain += " -> ";
+        chain += objectName(netlist.nodes[node]) + " @" + std::to_string(time).substr(0, 5);
+    }
+    SDL_Log("  critical: %s", chain.c_str());
+}
+
+void TimingAnalysis::render(SDL_Renderer* renderer) const {
+    if (isStale()) return;
+
+    SDL_SetRenderDrawColor(renderer, 255, 64, 64, 255);
+    for (const auto* obj : criticalObjects) {
+        if (obj->kind == KIND_WIRE) {
+            SDL_FPoint start, end;
+            if (!static_cast<const Wire*>(obj)->endpoints(start, end)) continue;
+            const SDL_FPoint from = camera.toScreen(start.x, start.y);
+            const SDL_FPoint to = camera.toScreen(end.x, end.y);
+            SDL_RenderLine(renderer, from.x, from.y, to.x, to.y);
+            continue;
+        }
+        const SDL_FRect body = camera.toScreen(obj->bounds());
+        const SDL_FRect outline = {body.x - 2, body.y - 2, body.w + 4, body.h + 4};
+        SDL_RenderRect(renderer, &outline);
+    }
+}
@@ -0,0 +1,55 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef TIMING_HPP
+#define TIMING_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "Simulator.hpp"
+
+class Netlist;
+
+// Propagation delays in nanoseconds
+struct DelayModel {
+    float gateDelay[8] = {0.05f, 0.03f, 0.08f, 0.08f, 0.06f, 0.07f, 0.12f, 0.12f}; // Indexed by GateType
+    float wireDelay = 0.01f;
+    float clockToQ = 0.15f;
+    float setup = 0.10f;
+    float memoryDelay = 1.5f; // Address to data of a RAM or ROM
+    float clockPeriod = 10.0f; // Required time at every endpoint
+};
+
+// Static timing analysis: one topological longest-path pass over a levelized netlist. Paths start
+// at buttons, clocks and flip-flop outputs, and end at flip-flop data pins, which must be stable
+// `setup` before the next clock edge, and at leds, which must be stable by the end of the period.
+class TimingAnalysis {
+public:
+    struct Path {
+        float arrival; // At the endpoint, including setup
+        float slack;
+        std::vector<Uint32> nodes; // From the startpoint to the endpoint
+    };
+
+    std::vector<float> arrival; // Per node, when its output settles
+    std::vector<Uint32> predecessor; // Per node, the fan-in that arrives last, NO_NODE at startpoints
+    std::vector<Path> paths; // The worst endpoints, worst first
+    Uint64 version = 0; // netlistVersion of the analysed netlist
+
+    static constexpr Uint32 NO_NODE = 0xffffffff;
+
+    void analyze(const Netlist& netlist, const DelayModel& model, size_t topPaths);
+    bool isStale() const { return version != netlistVersion; }
+
+    // Logs the worst paths, object by object
+    void report(const Netlist& netlist) const;
+    // Outlines the objects on the worst path in the canvas
+    void render(SDL_Renderer* renderer) const;
+
+private:
+    std::vector<Object*> criticalObjects;
+};
+
+#endif //TIMING_HPP
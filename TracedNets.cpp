@@ -0,0 +1,22 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "TracedNets.hpp"
+#include "Simulator.hpp"
+
+void TracedNets::assign(const std::vector<Object*>& objects) {
+    nets.clear();
+    netOf.clear();
+    for (const auto* obj : objects) {
+        nets.push_back(obj->handle);
+        if (obj->handle.slot >= netOf.size()) netOf.resize(obj->handle.slot + 1);
+        netOf[obj->handle.slot] = {static_cast<Uint32>(nets.size()), obj->handle.generation};
+    }
+}
+
+void TracedNets::clear() {
+    nets.clear();
+    netOf.clear();
+}
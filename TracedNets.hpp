@@ -0,0 +1,40 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef TRACEDNETS_HPP
+#define TRACEDNETS_HPP
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "ObjectSlots.hpp"
+
+class Object;
+
+// Maps the objects chosen for tracing to dense net numbers. Lookups are by handle slot, which
+// edits don't move, and the generation is checked, so an object that later takes the slot of a
+// deleted net isn't traced in its place.
+class TracedNets {
+public:
+    std::vector<ObjectHandle> nets; // Traced objects, by net number
+
+    void assign(const std::vector<Object*>& objects);
+    void clear();
+
+    // Net number + 1 of a traced object, or 0 if it isn't traced
+    Uint32 lookup(const ObjectHandle handle) const {
+        if (handle.slot >= netOf.size() || netOf[handle.slot].generation != handle.generation) return 0;
+        return netOf[handle.slot].net;
+    }
+
+private:
+    // By handle slot. The generation sits next to the net number, so a lookup touches one entry.
+    struct Entry {
+        Uint32 net = 0; // Net number + 1, or 0
+        Uint32 generation = 0;
+    };
+    std::vector<Entry> netOf;
+};
+
+#endif //TRACEDNETS_HPP
@@ -0,0 +1,173 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "VcdWriter.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+VcdWriter::VcdWriter(const size_t capacity) {
+    ring.resize(std::bit_ceil(capacity));
+    mask = ring.size() - 1;
+}
+
+VcdWriter::~VcdWriter() {
+    close();
+}
+
+// VCD identifiers are base-94 numbers written with the printable ASCII characters
+std::string VcdWriter::identifier(Uint32 net) {
+    std::string id;
+    do {
+        id.push_back(static_cast<char>('!' + net % 94));
+        net /= 94;
+    } while (net > 0);
+    return id;
+}
+
+/**
+ * @brief Writes the VCD header and the current values, then starts tracing in the background.
+ * @param path File to write.
+ * @param nets Objects to trace.
+ * @return false if the file couldn't be created.
+ */
+bool VcdWriter::open(const char* path, const std::vector<Object*>& nets) {
+    close();
+
+    file = SDL_IOFromFile(path, "wb");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    traced.assign(nets);
+    std::vector<std::string> ids;
+    idText.clear();
+    idStart.assign(1, 0);
+    for (Uint32 net = 0; net < nets.size(); ++net) {
+        ids.push_back(identifier(net));
+        idText.insert(idText.end(), ids.back().begin(), ids.back().end());
+        idText.push_back('\n');
+        idStart.push_back(static_cast<Uint32>(idText.size()));
+    }
+
+    std::string header = "$date\n    LogicSim trace\n$end\n$timescale 1ns $end\n$scope module logicsim $end\n";
+    for (Uint32 net = 0; net < nets.size(); ++net) {
+        header += "$var wire 1 " + ids[net] + " " + objectName(nets[net]) + " $end\n";
+    }
+    header += "$upscope $end\n$enddefinitions $end\n#" + std::to_string(simTime) + "\n$dumpvars\n";
+    for (Uint32 net = 0; net < nets.size(); ++net) {
+        header += (nets[net]->state() ? '1' : '0') + ids[net] + "\n";
+    }
+    header += "$end\n";
+    SDL_WriteIO(file, header.data(), header.size());
+
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    cachedTail = 0;
+    pushedTime = simTime;
+    timeShift = 0;
+    stopping.store(false, std::memory_order_relaxed);
+    writer = std::thread(&VcdWriter::run, this);
+
+    SDL_Log("Tracing %zu nets to %s.", nets.size(), path);
+    return true;
+}
+
+void VcdWriter::close() {
+    if (!file) return;
+
+    stopping.store(true, std::memory_order_release);
+    if (writer.joinable()) writer.join();
+    SDL_CloseIO(file);
+    file = nullptr;
+    traced.clear();
+    idText.clear();
+    idStart.clear();
+}
+
+void VcdWriter::onChange(const Object* obj) {
+    const Uint32 net = traced.lookup(obj->handle);
+    if (net == 0) return;
+
+    // After a restore to an earlier time the trace carries on from where it was
+    if (simTime + timeShift < pushedTime) timeShift = pushedTime - simTime;
+    const Uint64 time = simTime + timeShift;
+
+    // A time marker and the change after it are published together, so the writer never sees half of one
+    size_t h = head.load(std::memory_order_relaxed);
+    const bool mark = time != pushedTime;
+    const size_t words = mark ? 4 : 1;
+    if (h + words - cachedTail > ring.size()) {
+        // Buffer full: wait for the writer rather than lose history
+        while (h + words - (cachedTail = tail.load(std::memory_order_acquire)) > ring.size()) {
+            std::this_thread::yield();
+        }
+    }
+    if (mark) {
+        ring[h++ & mask] = TIME_MARK;
+        ring[h++ & mask] = static_cast<Uint32>(time);
+        ring[h++ & mask] = static_cast<Uint32>(time >> 32);
+        pushedTime = time;
+    }
+    ring[h++ & mask] = (net - 1) << 1 | (obj->state() ? 1 : 0);
+    head.store(h, std::memory_order_release);
+}
+
+void VcdWriter::run() {
+    // Lines are formatted straight into a fixed buffer, which a line never overflows: a time is at
+    // most 22 characters, an identifier at most 5 plus the value and the newline
+    constexpr size_t FLUSH_SIZE = 1 << 20;
+    constexpr size_t MAX_LINE = 32;
+    std::vector<char> buffer(FLUSH_SIZE + 2 * MAX_LINE);
+    char* out = buffer.data();
+    char* const flushAt = buffer.data() + FLUSH_SIZE;
+
+    const auto putTime = [&](const Uint64 time) {
+        *out++ = '#';
+        out = std::to_chars(out, out + MAX_LINE, time).ptr;
+        *out++ = '\n';
+    };
+
+    while (true) {
+        // Read stopping before head, so that records pushed before close() are not lost
+        const bool stop = stopping.load(std::memory_order_acquire);
+        const size_t h = head.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_relaxed);
+
+        if (t == h) {
+            if (stop) break;
+            // The ring holds many milliseconds of changes, so polling rarely is enough and keeps the
+            // writer from preempting the simulation
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        while (t != h) {
+            const Uint32 word = ring[t++ & mask];
+            if (word == TIME_MARK) {
+                const Uint32 low = ring[t++ & mask];
+                putTime(static_cast<Uint64>(ring[t++ & mask]) << 32 | low);
+                continue;
+            }
+            *out++ = word & 1 ? '1' : '0';
+            const Uint32 start = idStart[word >> 1];
+            const Uint32 length = idStart[(word >> 1) + 1] - start;
+            std::memcpy(out, idText.data() + start, length);
+            out += length;
+
+            if (out >= flushAt) {
+                SDL_WriteIO(file, buffer.data(), out - buffer.data());
+                out = buffer.data();
+            }
+        }
+        tail.store(t, std::memory_order_release);
+    }
+
+    putTime(std::max(simTime + timeShift, pushedTime));
+    SDL_WriteIO(file, buffer.data(), out - buffer.data());
+}
@@ -0,0 +1,60 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef VCDWRITER_HPP
+#define VCDWRITER_HPP
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Simulator.hpp"
+#include "TracedNets.hpp"
+
+// Streams the history of a set of objects to a Value Change Dump file. The simulation only
+// pushes (net, value) words into a single-producer single-consumer ring buffer, with a time
+// marker whenever the time moves on; a background thread formats them and writes the file.
+// One VCD time unit is one delta cycle.
+class VcdWriter final : public ChangeListener {
+public:
+    explicit VcdWriter(size_t capacity = 1 << 20);
+    ~VcdWriter() override;
+
+    bool open(const char* path, const std::vector<Object*>& nets);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    void onChange(const Object* obj) override;
+
+private:
+    // A ring word is net << 1 | value, or TIME_MARK followed by the new time in two words
+    static constexpr Uint32 TIME_MARK = 0xffffffff;
+
+    // Ring buffer. head is only written by the simulation, tail only by the writer thread.
+    std::vector<Uint32> ring;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedTail = 0; // Producer's last view of tail, to avoid touching the shared cache line
+    Uint64 pushedTime = 0; // Time of the last marker pushed
+    // Added to simTime once a restore or rewind took it back, as the trace can only go forward
+    Uint64 timeShift = 0;
+
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+    SDL_IOStream* file = nullptr;
+
+    TracedNets traced;
+    // VCD identifier and newline of every net, back to back, read by the writer thread. Net n is
+    // idText[idStart[n]] .. idText[idStart[n + 1] - 1].
+    std::vector<char> idText;
+    std::vector<Uint32> idStart;
+
+    void run();
+    static std::string identifier(Uint32 net);
+};
+
+#endif //VCDWRITER_HPP
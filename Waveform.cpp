@@ -0,0 +1,265 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include "Waveform.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr Uint8 WAVEFORM_MAGIC[4] = {'L', 'S', 'W', 'F'};
+static constexpr Uint32 WAVEFORM_FORMAT = 2;
+
+template<typename T>
+static void put(std::vector<Uint8>& out, const T value) {
+    const auto* bytes = reinterpret_cast<const Uint8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+WaveformWriter::~WaveformWriter() {
+    close();
+}
+
+/**
+ * @brief Creates a waveform file and starts recording the given objects.
+ * @param path File to write.
+ * @param nets Objects to record.
+ * @return false if the file couldn't be created.
+ */
+bool WaveformWriter::open(const char* path, const std::vector<Object*>& nets) {
+    close();
+
+    file = SDL_IOFromFile(path, "wb");
+    if (!file) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    traced.assign(nets);
+    pending.assign(nets.size(), {});
+    index.clear();
+    out.clear();
+    outOffset = 0;
+    lastTime = simTime;
+    timeShift = 0;
+
+    out.insert(out.end(), std::begin(WAVEFORM_MAGIC), std::end(WAVEFORM_MAGIC));
+    put(out, WAVEFORM_FORMAT);
+    put(out, static_cast<Uint32>(nets.size()));
+    put(out, simTime);
+    for (const auto* obj : nets) {
+        const std::string name = objectName(obj);
+        put(out, static_cast<Uint8>(obj->state()));
+        put(out, static_cast<Uint16>(name.size()));
+        out.insert(out.end(), name.begin(), name.end());
+    }
+
+    SDL_Log("Recording %zu nets to %s.", nets.size(), path);
+    return true;
+}
+
+void WaveformWriter::onChange(const Object* obj) {
+    const Uint32 net = traced.lookup(obj->handle);
+    if (net == 0) return;
+
+    // After a restore to an earlier time the recording carries on from where it was
+    if (simTime + timeShift < lastTime) timeShift = lastTime - simTime;
+    lastTime = simTime + timeShift;
+
+    auto& changes = pending[net - 1];
+    changes.push_back(lastTime << 1 | obj->state());
+    if (changes.size() == BLOCK_CHANGES) writeBlock(net - 1);
+}
+
+void WaveformWriter::writeBlock(const Uint32 signal) {
+    auto& changes = pending[signal];
+    if (changes.empty()) return;
+
+    WaveformBlock block{};
+    block.signal = signal;
+    block.changes = static_cast<Uint32>(changes.size());
+    block.firstTime = changes.front() >> 1;
+    block.lastTime = changes.back() >> 1;
+    block.offset = outOffset + out.size();
+    block.firstValue = changes.front() & 1;
+    block.lastValue = changes.back() & 1;
+
+    Uint64 prev = block.firstTime;
+    for (size_t i = 1; i < changes.size(); ++i) {
+        const Uint64 time = changes[i] >> 1;
+        Uint64 entry = (time - prev) << 1 | (changes[i] & 1);
+        prev = time;
+        while (entry >= 0x80) {
+            out.push_back(static_cast<Uint8>(entry | 0x80));
+            entry >>= 7;
+        }
+        out.push_back(static_cast<Uint8>(entry));
+    }
+    block.size = static_cast<Uint32>(outOffset + out.size() - block.offset);
+    index.push_back(block);
+    changes.clear();
+
+    if (out.size() >= 1 << 20) flushOutput();
+}
+
+void WaveformWriter::flushOutput() {
+    SDL_WriteIO(file, out.data(), out.size());
+    outOffset += out.size();
+    out.clear();
+}
+
+void WaveformWriter::close() {
+    if (!file) return;
+
+    for (Uint32 signal = 0; signal < pending.size(); ++signal) {
+        writeBlock(signal);
+    }
+
+    const Uint64 indexOffset = outOffset + out.size();
+    const auto* indexBytes = reinterpret_cast<const Uint8*>(index.data());
+    out.insert(out.end(), indexBytes, indexBytes + index.size() * sizeof(WaveformBlock));
+    put(out, indexOffset);
+    put(out, static_cast<Uint64>(index.size()));
+    out.insert(out.end(), std::begin(WAVEFORM_MAGIC), std::end(WAVEFORM_MAGIC));
+    flushOutput();
+
+    SDL_CloseIO(file);
+    file = nullptr;
+    traced.clear();
+    pending.clear();
+    index.clear();
+}
+
+bool WaveformReader::open(const char* path) {
+    close();
+    if (!file.open(path)) return false;
+
+    const Uint8* data = file.data();
+    const size_t size = file.size();
+    constexpr size_t FOOTER_SIZE = 2 * sizeof(Uint64) + sizeof(WAVEFORM_MAGIC);
+    constexpr size_t HEADER_SIZE = sizeof(WAVEFORM_MAGIC) + 2 * sizeof(Uint32) + sizeof(Uint64);
+
+    Uint64 indexOffset = 0, blockCount = 0;
+    bool valid = size >= HEADER_SIZE + FOOTER_SIZE &&
+                 std::memcmp(data, WAVEFORM_MAGIC, sizeof(WAVEFORM_MAGIC)) == 0 &&
+                 std::memcmp(data + size - sizeof(WAVEFORM_MAGIC), WAVEFORM_MAGIC, sizeof(WAVEFORM_MAGIC)) == 0;
+    Uint32 format = 0, signals = 0;
+    if (valid) {
+        std::memcpy(&format, data + 4, sizeof(format));
+        std::memcpy(&signals, data + 8, sizeof(signals));
+        std::memcpy(&start, data + 12, sizeof(start));
+        std::memcpy(&indexOffset, data + size - FOOTER_SIZE, sizeof(indexOffset));
+        std::memcpy(&blockCount, data + size - FOOTER_SIZE + sizeof(Uint64), sizeof(blockCount));
+        valid = format == WAVEFORM_FORMAT && indexOffset <= size - FOOTER_SIZE &&
+                blockCount == (size - FOOTER_SIZE - indexOffset) / sizeof(WaveformBlock);
+    }
+
+    // Signal table
+    size_t offset = HEADER_SIZE;
+    for (Uint32 i = 0; valid && i < signals; ++i) {
+        Uint16 length = 0;
+        if (offset + 3 > indexOffset) {
+            valid = false;
+            break;
+        }
+        initial.push_back(data[offset]);
+        std::memcpy(&length, data + offset + 1, sizeof(length));
+        offset += 3;
+        if (offset + length > indexOffset) {
+            valid = false;
+            break;
+        }
+        names.emplace_back(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+    }
+
+    if (valid) {
+        blocks.resize(blockCount);
+        std::memcpy(blocks.data(), data + indexOffset, blockCount * sizeof(WaveformBlock));
+        blocksOf.assign(signals, {});
+        for (Uint32 i = 0; i < blocks.size(); ++i) {
+            const auto& block = blocks[i];
+            if (block.signal >= signals || block.changes == 0 || block.offset + block.size > indexOffset) {
+                valid = false;
+                break;
+            }
+            blocksOf[block.signal].push_back(i);
+        }
+    }
+
+    if (!valid) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "%s is not a valid waveform file.", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WaveformReader::close() {
+    file.close();
+    names.clear();
+    initial.clear();
+    blocks.clear();
+    blocksOf.clear();
+    start = 0;
+}
+
+int WaveformReader::findSignal(const std::string& name) const {
+    const auto it = std::ranges::find(names, name);
+    return it == names.end() ? -1 : static_cast<int>(it - names.begin());
+}
+
+// Calls visit(time, value) for every change in the block until it returns false
+template<typename Visitor>
+void WaveformReader::decode(const WaveformBlock& block, Visitor visit) const {
+    const Uint8* in = file.data() + block.offset;
+    const Uint8* end = in + block.size;
+    Uint64 time = block.firstTime;
+    bool value = block.firstValue;
+    if (!visit(time, value)) return;
+
+    for (Uint32 i = 1; i < block.changes && in < end; ++i) {
+        Uint64 entry = 0;
+        int shift = 0;
+        while (in < end && *in & 0x80) {
+            entry |= static_cast<Uint64>(*in++ & 0x7f) << shift;
+            shift += 7;
+        }
+        if (in < end) entry |= static_cast<Uint64>(*in++) << shift;
+        time += entry >> 1;
+        value = entry & 1;
+        if (!visit(time, value)) return;
+    }
+}
+
+bool WaveformReader::valueAt(const Uint32 signal, const Uint64 time) const {
+    const auto& list = blocksOf[signal];
+    // Last block that starts at or before time
+    const auto it = std::ranges::upper_bound(list, time, {}, [&](const Uint32 b) { return blocks[b].firstTime; });
+    if (it == list.begin()) return initial[signal];
+
+    bool value = initial[signal];
+    decode(blocks[*(it - 1)], [&](const Uint64 t, const bool v) {
+        if (t > time) return false;
+        value = v;
+        return true;
+    });
+    return value;
+}
+
+std::vector<WaveformChange> WaveformReader::read(const Uint32 signal, const Uint64 from, const Uint64 to) const {
+    std::vector<WaveformChange> changes;
+    const auto& list = blocksOf[signal];
+
+    // First block that ends at or after from
+    auto it = std::ranges::lower_bound(list, from, {}, [&](const Uint32 b) { return blocks[b].lastTime; });
+    for (; it != list.end() && blocks[*it].firstTime <= to; ++it) {
+        decode(blocks[*it], [&](const Uint64 t, const bool v) {
+            if (t > to) return false;
+            if (t >= from) changes.push_back({t, v});
+            return true;
+        });
+    }
+    return changes;
+}
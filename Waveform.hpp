@@ -0,0 +1,102 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#ifndef WAVEFORM_HPP
+#define WAVEFORM_HPP
+
+#include <SDL3/SDL.h>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "Simulator.hpp"
+#include "TracedNets.hpp"
+
+// Compact binary waveform format (.lswf).
+//
+// Header:  "LSWF", format, signal count, start time, then per signal its initial value and name.
+// Blocks:  the changes of one signal after the first one of the block, each as a varint of the
+//          time delta from the previous change shifted left by one, with the new value in bit 0.
+//          Values are stored rather than implied by toggling, so a block decodes on its own.
+//          A restore or rewind is recorded as changes at the time it happened, as times only
+//          go forward in the file.
+// Index:   one WaveformBlock per block, in the order they were written.
+// Footer:  index offset, block count, "LSWF".
+//
+// Blocks of a signal are written in time order, so a reader can binary search the index and
+// decode only the blocks overlapping the range it's interested in.
+
+struct WaveformBlock {
+    Uint32 signal;
+    Uint32 changes;
+    Uint64 firstTime;
+    Uint64 lastTime;
+    Uint64 offset; // File offset of the encoded deltas
+    Uint32 size; // Size of the encoded deltas in bytes
+    Uint8 firstValue; // Value after the first change
+    Uint8 lastValue; // Value after the last change
+    Uint8 reserved[2];
+};
+static_assert(sizeof(WaveformBlock) == 40, "WaveformBlock is written to disk as is");
+
+struct WaveformChange {
+    Uint64 time;
+    bool value;
+};
+
+class WaveformWriter final : public ChangeListener {
+public:
+    static constexpr size_t BLOCK_CHANGES = 4096;
+
+    ~WaveformWriter() override;
+
+    bool open(const char* path, const std::vector<Object*>& nets);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    void onChange(const Object* obj) override;
+
+private:
+    SDL_IOStream* file = nullptr;
+    TracedNets traced;
+    // Changes per signal not yet written as a block, as time << 1 | value
+    std::vector<std::vector<Uint64>> pending;
+    std::vector<WaveformBlock> index;
+    std::vector<Uint8> out; // Encoded blocks not yet written to the file
+    Uint64 outOffset = 0; // File offset of out[0]
+    Uint64 lastTime = 0; // Of the last change recorded
+    // Added to simTime once a restore or rewind took it back, as the changes must stay in time order
+    Uint64 timeShift = 0;
+
+    void writeBlock(Uint32 signal);
+    void flushOutput();
+};
+
+class WaveformReader {
+public:
+    bool open(const char* path);
+    void close();
+
+    size_t signalCount() const { return names.size(); }
+    const std::string& signalName(const Uint32 signal) const { return names[signal]; }
+    int findSignal(const std::string& name) const;
+    Uint64 startTime() const { return start; }
+
+    bool valueAt(Uint32 signal, Uint64 time) const;
+    // All changes of a signal with from <= time <= to, decoding only the blocks in that range
+    std::vector<WaveformChange> read(Uint32 signal, Uint64 from, Uint64 to) const;
+
+private:
+    MappedFile file;
+    Uint64 start = 0;
+    std::vector<std::string> names;
+    std::vector<Uint8> initial;
+    std::vector<WaveformBlock> blocks;
+    std::vector<std::vector<Uint32>> blocksOf; // Blocks of every signal, in time order
+
+    template<typename Visitor>
+    void decode(const WaveformBlock& block, Visitor visit) const;
+};
+
+#endif //WAVEFORM_HPP
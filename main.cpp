@@ -1,6 +1,9 @@
 #define SDL_MAIN_USE_CALLBACKS 1
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
+#include <random>
 #include <vector>
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
@@ -8,17 +11,67 @@
 #include "Simulator.hpp"
 #include "DragAndDrop.hpp"
 #include "ShortcutManager.hpp"
+#include "CycleSimulator.hpp"
+#include "Checkpoint.hpp"
+#include "Journal.hpp"
+#include "VcdWriter.hpp"
+#include "Waveform.hpp"
+#include "Netlist.hpp"
+#include "CombinationalModel.hpp"
+#include "FaultSimulator.hpp"
+#include "Atpg.hpp"
+#include "Regression.hpp"
+#include "Activity.hpp"
+#include "Stimulus.hpp"
+#include "Timing.hpp"
+#include "TextureCache.hpp"
+#include "SpriteBatch.hpp"
+#include "LineBatch.hpp"
+#include "Camera.hpp"
 
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
 
 std::vector<Object*> objects;
 std::vector<Object*> selectedObjects;
-std::queue<Object*> eventQueue;
+std::vector<Object*> objectsOfKind[KIND_COUNT];
+std::queue<ObjectHandle> eventQueue;
+ObjectSlots objectSlots;
+SimulationData simulationData;
+SpatialIndex spatialIndex;
+Camera camera;
+std::vector<Object*> sequentialQueue;
+Uint64 netlistVersion = 0;
+Uint64 simTime = 0;
+size_t deltaRemaining = 0;
+std::vector<ChangeListener*> changeListeners;
+std::deque<ObjectView> objectViews;
+
+CycleSimulator cycleSimulator;
+bool cycleMode = false; // Advance clocked logic with the cycle-based engine instead of the event queue
+
+Journal journal;
+VcdWriter vcdWriter;
+WaveformWriter waveformWriter;
+ActivityRecorder activityRecorder;
+TextureCache textureCache;
+SpriteBatch spriteBatch;
+LineBatch lineBatch;
+TimingAnalysis timing; // Critical paths of the last analysis, highlighted until the circuit changes
+bool paused = false;
 
 Uint64 lastFrameTicks = 0;
 constexpr Uint64 targetFrameTime = 1000 / 125; // Target frame time for 125 FPS
 
+// Objects to trace: the selection, or everything if nothing is selected
+static std::vector<Object*> tracedObjects() {
+    std::vector<Object*> nets;
+    for (auto* obj : selectedObjects.empty() ? objects : selectedObjects) {
+        if (obj->kind != KIND_FAKE) nets.push_back(obj);
+    }
+    return nets;
+}
+
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[]) {
     SDL_SetAppMetadata("Logic Sim", "1.0", "com.kfragkoulis.logicsim");
 
@@ -32,24 +85,185 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[]) {
         return SDL_APP_FAILURE;
     }
 
+    changeListeners.push_back(&journal);
+
     auto& shortcutManager = ShortcutManager::instance();
     shortcutManager.registerShortcut({SDLK_Q, SDL_KMOD_CTRL}, []() {
         SDL_Log("Ctrl+Q pressed, quitting application.");
     });
 
+    shortcutManager.registerShortcut({SDLK_M, SDL_KMOD_CTRL}, [] {
+        cycleMode = !cycleMode;
+        SDL_Log("Cycle-based simulation %s.", cycleMode ? "enabled" : "disabled");
+    });
+
+    shortcutManager.registerShortcut({SDLK_F5, SDL_KMOD_NONE}, [] {
+        saveCheckpointFile("logicsim.ckpt");
+    });
+
+    shortcutManager.registerShortcut({SDLK_F9, SDL_KMOD_NONE}, [] {
+        loadCheckpointFile("logicsim.ckpt");
+    });
+
+    shortcutManager.registerShortcut({SDLK_P, SDL_KMOD_CTRL}, [] {
+        paused = !paused;
+        SDL_Log("Simulation %s at time %llu.", paused ? "paused" : "resumed", static_cast<unsigned long long>(simTime));
+    });
+
+    shortcutManager.registerShortcut({SDLK_LEFT, SDL_KMOD_CTRL}, [] {
+        paused = true;
+        if (journal.stepBack()) {
+            SDL_Log("Stepped back to time %llu.", static_cast<unsigned long long>(simTime));
+        }
+    });
+
+    shortcutManager.registerShortcut({SDLK_RIGHT, SDL_KMOD_CTRL}, [] {
+        paused = true;
+        if (journal.stepForward()) {
+            SDL_Log("Stepped forward to time %llu.", static_cast<unsigned long long>(simTime));
+        }
+    });
+
+    shortcutManager.registerShortcut({SDLK_T, SDL_KMOD_CTRL}, [] {
+        if (vcdWriter.isOpen()) {
+            std::erase(changeListeners, &vcdWriter);
+            vcdWriter.close();
+            SDL_Log("Stopped tracing.");
+            return;
+        }
+
+        if (vcdWriter.open("trace.vcd", tracedObjects())) {
+            changeListeners.push_back(&vcdWriter);
+        }
+    });
+
+    shortcutManager.registerShortcut({SDLK_W, SDL_KMOD_CTRL}, [] {
+        if (waveformWriter.isOpen()) {
+            std::erase(changeListeners, &waveformWriter);
+            waveformWriter.close();
+            SDL_Log("Stopped recording.");
+            return;
+        }
+
+        if (waveformWriter.open("trace.lswf", tracedObjects())) {
+            changeListeners.push_back(&waveformWriter);
+        }
+    });
+
+    // Counts toggles in the running simulation, and reports them and the power estimate when stopped
+    shortcutManager.registerShortcut({SDLK_E, SDL_KMOD_CTRL}, [] {
+        if (std::ranges::find(changeListeners, &activityRecorder) == changeListeners.end()) {
+            activityRecorder.restart();
+            changeListeners.push_back(&activityRecorder);
+            SDL_Log("Counting toggles from time %llu.", static_cast<unsigned long long>(simTime));
+            return;
+        }
+
+        std::erase(changeListeners, &activityRecorder);
+        CompiledCircuit circuit;
+        circuit.compile(objects);
+        const ToggleCounter activity = activityRecorder.counts(circuit);
+        writeSaif("activity.saif", circuit, activity);
+        const double power = estimatePower(circuit, activity, PowerModel{});
+        SDL_Log("Counted toggles over %llu time units. Estimated dynamic power: %.3f uW at %.0f MHz.",
+            static_cast<unsigned long long>(activity.samples), power * 1e6, PowerModel{}.frequency / 1e6);
+    });
+
+    shortcutManager.registerShortcut({SDLK_F, SDL_KMOD_CTRL}, [] {
+        Netlist netlist;
+        netlist.compile(objects);
+        CombinationalModel model;
+        if (!model.compile(netlist)) return;
+
+        // Grade the stuck-at faults against random patterns until coverage stops improving
+        constexpr size_t MAX_PATTERNS = 4096;
+        constexpr size_t PATIENCE = 256;
+        FaultSimulator faultSimulator(model);
+        std::mt19937_64 rng(1);
+        Pattern pattern(model.inputs.size());
+        size_t useless = 0;
+        for (size_t i = 0; i < MAX_PATTERNS && useless < PATIENCE; ++i) {
+            for (size_t k = 0; k < pattern.size(); ++k) pattern[k] = rng() & 1;
+            useless = faultSimulator.simulate(pattern) > 0 ? 0 : useless + 1;
+            if (faultSimulator.detectedCount() == faultSimulator.faults.size()) break;
+        }
+        faultSimulator.writeReport("faults.txt");
+    });
+
+    shortcutManager.registerShortcut({SDLK_G, SDL_KMOD_CTRL}, [] {
+        Netlist netlist;
+        netlist.compile(objects);
+        CombinationalModel model;
+        if (!model.compile(netlist)) return;
+
+        Atpg atpg(model);
+        atpg.run();
+        atpg.writeVectors("tests.vec");
+    });
+
+    shortcutManager.registerShortcut({SDLK_R, SDL_KMOD_CTRL}, [] {
+        constexpr Uint64 FIRST_SEED = 1;
+        constexpr size_t SEEDS = 64;
+        constexpr Uint64 CYCLES = 1000;
+        constexpr const char* EXPECTED = "regression.vec";
+
+        Regression regression;
+        regression.compile(objects);
+        regression.collectActivity = true;
+        // The outputs are checked against those of the first run, e.g. of the design before a change.
+        // Deleting the file records them again. A file that no longer fits the circuit is a failure
+        // to report, not a baseline to replace.
+        const bool record = !SDL_GetPathInfo(EXPECTED, nullptr);
+        if (!record && !regression.loadExpected(EXPECTED, FIRST_SEED, SEEDS, CYCLES)) {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Regression: the outputs in %s don't fit the circuit, "
+                         "nothing is checked. Delete the file to record them again.", EXPECTED);
+        }
+        regression.recordOutputs = record;
+        const auto results = regression.run(FIRST_SEED, SEEDS, CYCLES);
+        if (record && regression.writeExpected(EXPECTED, results)) {
+            SDL_Log("Recorded the expected outputs in %s.", EXPECTED);
+        }
+
+        writeSaif("activity.saif", regression.circuit, regression.activity);
+        const double power = estimatePower(regression.circuit, regression.activity, PowerModel{});
+        SDL_Log("Estimated dynamic power: %.3f uW at %.0f MHz.", power * 1e6, PowerModel{}.frequency / 1e6);
+
+        std::vector<Uint64> signatures;
+        for (const auto& result : results) signatures.push_back(result.signature);
+        std::ranges::sort(signatures);
+        const auto distinct = std::ranges::unique(signatures).begin() - signatures.begin();
+        SDL_Log("Regression: %lld distinct output traces.", static_cast<long long>(distinct));
+    });
+
+    // Replays tests.vec, e.g. the vectors written by Ctrl+G, against the current circuit
+    shortcutManager.registerShortcut({SDLK_L, SDL_KMOD_CTRL}, [] {
+        CompiledCircuit circuit;
+        circuit.compile(objects);
+        StimulusRunner runner(circuit);
+        runner.run("tests.vec");
+    });
+
+    shortcutManager.registerShortcut({SDLK_K, SDL_KMOD_CTRL}, [] {
+        Netlist netlist;
+        netlist.compile(objects);
+        timing.analyze(netlist, DelayModel{}, 5);
+        timing.report(netlist);
+    });
+
     shortcutManager.registerShortcut({SDLK_DELETE, SDL_KMOD_NONE}, [] {
         SDL_Log("Delete pressed.");
         for (auto *obj : selectedObjects) {
             for (const auto& outputPin : obj->outputPins) {
                 for (auto *outputObj : outputPin) {
                     if (outputObj == nullptr) continue;
-                    eventQueue.push(outputObj);
-                    outputObj->queued = true;
+                    eventQueue.push(outputObj->handle);
+                    outputObj->queued() = true;
                 }
             }
-            std::erase(objects, obj);
+            // Removes itself from objects
             delete obj;
         }
+        selectedObjects.clear();
     });
 
     const auto btn1 = new Button(renderer, 10, 10);
@@ -69,13 +283,22 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[]) {
     const auto led1 = new Led(renderer, 400, 100);
     const auto led2 = new Led(renderer, 500, 100);
     const auto clk = new Clock(renderer, 10, 300, 1);
+    const auto dff = new FlipFlop(renderer, DFF, 300, 300);
+    const auto ram = new Ram(renderer, 600, 250);
+
+    // An optional binary image given on the command line is mapped into a ROM
+    if (argc > 1) {
+        const auto rom = new Rom(renderer, 450, 250);
+        rom->load(argv[1]);
+    }
 
     return SDL_APP_CONTINUE;
 }
 
 SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event) {
     ShortcutManager::instance().processEvent(*event);
-    handleDragAndDrop(event);
+    // Panning and zooming don't select or move anything
+    if (!camera.handleEvent(event)) handleDragAndDrop(event);
     switch (event->type) {
     case SDL_EVENT_QUIT:
         return SDL_APP_SUCCESS;
@@ -84,54 +307,69 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event) {
     }
 }
 
-SDL_AppResult SDL_AppIterate(void* appstate) {
-    // Add all clocks to the event queue
-    for (auto * obj : objects) {
-        if (auto* clk = dynamic_cast<Clock *>(obj)) {
-            if (!clk->queued) {
-                eventQueue.push(clk);
-                clk->queued = true;
-            }
+// Queues the objects on screen, including wires crossing it, in drawing order
+static void renderCanvas() {
+    int width, height;
+    SDL_GetCurrentRenderOutputSize(renderer, &width, &height);
+    const SDL_FRect area = camera.visibleArea(width, height);
+
+    // Zoomed out this far objects are a few pixels at most, so the cells they are in are drawn
+    // instead, more opaque the more objects they hold
+    if (camera.overview()) {
+        for (const auto& [rect, count] : spatialIndex.occupiedCells(area)) {
+            const float alpha = std::min(1.0f, 0.2f + 0.1f * static_cast<float>(count));
+            spriteBatch.fill(renderer, camera.toScreen(rect), {200 / 255.0f, 200 / 255.0f, 200 / 255.0f, alpha});
         }
+        return;
     }
 
-    int steps = 0;
-    constexpr int MAX_STEPS = 1000;
-    while (!eventQueue.empty() && steps < MAX_STEPS) {
-        Object* obj = eventQueue.front();
-        eventQueue.pop();
+    // The query lists the topmost first. Selection borders and pin markers stick out of the bounds
+    // of an object by a few canvas units.
+    constexpr float OUTSET = 5.0f;
+    const std::vector<Object*> visible = spatialIndex.query({area.x - OUTSET, area.y - OUTSET, area.w + 2 * OUTSET,
+                                                             area.h + 2 * OUTSET});
+    for (auto it = visible.rbegin(); it != visible.rend(); ++it) {
+        (*it)->render(renderer);
+    }
+}
 
-        const bool changed = obj->eval();
-        if (changed) {
-            for (const auto& outputPin : obj->outputPins) {
-                for (auto* outputObj : outputPin) {
-                    if (outputObj == nullptr) {
-                        continue; // Skip if there is no output object
-                    }
-                    if (!outputObj->queued) {
-                        eventQueue.push(outputObj);
-                        outputObj->queued = true;
-                    }
+SDL_AppResult SDL_AppIterate(void* appstate) {
+    if (!paused) {
+        if (!cycleMode) {
+            // Add all clocks to the event queue
+            for (auto * clk : objectsOfKind[KIND_CLOCK]) {
+                if (!clk->queued()) {
+                    eventQueue.push(clk->handle);
+                    clk->queued() = true;
                 }
             }
         }
 
-        obj->queued = false;
-        steps++;
-    }
+        constexpr int MAX_STEPS = 1000;
+        const int steps = propagate(MAX_STEPS);
+
+        if (steps >= MAX_STEPS) {
+            SDL_Log("Warning: Maximum steps reached in event processing loop.");
+        }
 
-    if (steps >= MAX_STEPS) {
-        SDL_Log("Warning: Maximum steps reached in event processing loop.");
+        if (cycleMode) {
+            if (cycleSimulator.netlist.isStale()) {
+                cycleSimulator.compile();
+            }
+            cycleSimulator.advance(SDL_GetTicks());
+        }
     }
 
 
+    camera.update(SDL_GetTicks());
     SDL_SetRenderDrawColorFloat(renderer, 66.0 / 255, 67.0 / 255, 68.0 / 255, SDL_ALPHA_OPAQUE_FLOAT);
     SDL_RenderClear(renderer);
 
-    // Draw all objects
-    for (const auto obj : objects) {
-        if (obj) obj->render(renderer);
-    }
+    renderCanvas();
+    // Wires and sprites were queued by render(), they go out in a few draw calls, wires below
+    lineBatch.flush(renderer);
+    spriteBatch.flush(renderer);
+    timing.render(renderer);
     drawSelectionRect(renderer);
 
     SDL_RenderPresent(renderer);
@@ -150,6 +388,10 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 }
 
 void SDL_AppQuit(void* appstate, SDL_AppResult result) {
+    vcdWriter.close();
+    waveformWriter.close();
+    changeListeners.clear();
+
     std::vector<Object *> objCopy = objects;
     for (const auto obj : objCopy) {
         delete obj;
@@ -157,4 +399,6 @@ void SDL_AppQuit(void* appstate, SDL_AppResult result) {
 
     objCopy.clear();
     objects.clear();
+    spatialIndex.clear();
+    textureCache.clear();
 }
@@ -0,0 +1,91 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+
+#include "Simulator.hpp"
+#include "Netlist.hpp"
+#include "CombinationalModel.hpp"
+#include "FaultSimulator.hpp"
+#include "Atpg.hpp"
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what) {
+    if (condition) return;
+    SDL_LogError(SDL_LOG_CATEGORY_ERROR, "FAILED: %s", what);
+    failures++;
+}
+
+static void connect(Object* src, Object* dest, const int inputPin) {
+    auto* wire = new Wire(nullptr);
+    Object::connect(src, wire);
+    Object::connect(wire, dest, 0, inputPin);
+}
+
+// f = ab + a'c + bc. The consensus term bc never decides f on its own, so its AND stuck at 0 is
+// redundant, while every fault on the other gates can be tested.
+static void consensus() {
+    auto* a = new Button(nullptr);
+    auto* b = new Button(nullptr);
+    auto* c = new Button(nullptr);
+    auto* notA = new Gate(nullptr, NOT);
+    auto* ab = new Gate(nullptr, AND);
+    auto* notAc = new Gate(nullptr, AND);
+    auto* bc = new Gate(nullptr, AND);
+    auto* sum = new Gate(nullptr, OR);
+    auto* f = new Gate(nullptr, OR);
+    connect(a, notA, 0);
+    connect(a, ab, 0);
+    connect(b, ab, 1);
+    connect(notA, notAc, 0);
+    connect(c, notAc, 1);
+    connect(b, bc, 0);
+    connect(c, bc, 1);
+    connect(ab, sum, 0);
+    connect(notAc, sum, 1);
+    connect(sum, f, 0);
+    connect(bc, f, 1);
+    connect(f, new Led(nullptr), 0);
+
+    Netlist netlist;
+    netlist.compile(objects);
+    CombinationalModel model;
+    check(model.compile(netlist) && model.inputs.size() == 3, "building the model");
+
+    Atpg atpg(model);
+    atpg.run();
+
+    // Every pattern of three inputs tells which faults can be detected at all
+    FaultSimulator exhaustive(model);
+    for (Uint32 v = 0; v < 8; ++v) exhaustive.simulate(Pattern{(v & 1) != 0, (v & 2) != 0, (v & 4) != 0});
+    const size_t testable = exhaustive.detectedCount();
+
+    FaultSimulator generated(model);
+    generated.simulate(atpg.patterns);
+    check(atpg.faults == exhaustive.faults.size(), "ATPG targets every fault");
+    check(generated.detectedCount() == testable && atpg.detected == testable,
+          "the generated patterns detect every testable fault");
+    check(atpg.aborted == 0, "no fault of a small circuit is given up on");
+    // Detected and redundant account for all faults, so exactly the untestable ones were proven redundant
+    check(atpg.redundant == atpg.faults - testable, "every untestable fault is reported redundant");
+
+    bool found = false;
+    for (size_t i = 0; i < exhaustive.faults.size(); ++i) {
+        const Fault& fault = exhaustive.faults[i];
+        if (model.cells[fault.cell].node != bc->index || fault.pin != -1 || fault.stuckAt) continue;
+        found = true;
+        check(!exhaustive.detected[i], "the consensus term stuck at 0 is untestable");
+    }
+    check(found && atpg.redundant > 0, "the consensus term stuck at 0 is among the faults");
+
+    while (!objects.empty()) delete objects.back();
+}
+
+int main() {
+    consensus();
+    if (failures > 0) return 1;
+    SDL_Log("All ATPG tests passed.");
+    return 0;
+}
@@ -0,0 +1,122 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include <random>
+#include <vector>
+
+#include "Simulator.hpp"
+#include "Netlist.hpp"
+#include "CombinationalModel.hpp"
+#include "FaultSimulator.hpp"
+#include "Logic.hpp"
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what) {
+    if (condition) return;
+    SDL_LogError(SDL_LOG_CATEGORY_ERROR, "FAILED: %s", what);
+    failures++;
+}
+
+static void connect(Object* src, Object* dest, const int inputPin) {
+    auto* wire = new Wire(nullptr);
+    Object::connect(src, wire);
+    Object::connect(wire, dest, 0, inputPin);
+}
+
+// Outputs of the model for one pattern with at most one fault injected, a bit at a time
+static std::vector<bool> serialEvaluate(const CombinationalModel& model, const Pattern& pattern, const Fault* fault) {
+    std::vector<bool> values(model.signalCount, false);
+    for (size_t i = 0; i < pattern.size(); ++i) values[model.inputs[i]] = pattern[i];
+    const auto pinValue = [&](const Uint32 pin) {
+        bool value = false;
+        for (Uint32 s = model.pinSourceStart[pin]; s < model.pinSourceStart[pin + 1]; ++s) {
+            value = value || values[model.pinSources[s]];
+        }
+        return value;
+    };
+    for (Uint32 c = 0; c < model.cells.size(); ++c) {
+        const auto& cell = model.cells[c];
+        bool in[2] = {false, false};
+        for (Uint32 k = 0; k < cell.pins; ++k) {
+            in[k] = fault && fault->cell == c && fault->pin == static_cast<Sint32>(k) ? fault->stuckAt : pinValue(cell.pinStart + k);
+        }
+        const bool out = gateFunction(cell.type, in[0], in[1]) & 1;
+        values[cell.signal] = fault && fault->cell == c && fault->pin < 0 ? fault->stuckAt : out;
+    }
+    std::vector<bool> outputs;
+    for (const Uint32 pin : model.outputs) outputs.push_back(pinValue(pin));
+    return outputs;
+}
+
+// A random circuit with several passes worth of faults, wired ORs and a scan flip-flop, graded in
+// parallel and then one fault at a time
+static void matchesSerial() {
+    std::mt19937 rng(33);
+    std::vector<Object*> drivers;
+    for (int i = 0; i < 6; ++i) drivers.push_back(new Button(nullptr));
+    auto* flipFlop = new FlipFlop(nullptr, DFF);
+    connect(new Clock(nullptr), flipFlop, 1);
+    drivers.push_back(flipFlop);
+    for (int i = 0; i < 60; ++i) {
+        auto* gate = new Gate(nullptr, static_cast<GateType>(rng() % 8));
+        const int pins = static_cast<int>(gate->inputPins.size());
+        for (int pin = 0; pin < pins; ++pin) connect(drivers[rng() % drivers.size()], gate, pin);
+        // A second driver on the same pin, wired OR
+        if (i % 10 == 0) connect(drivers[rng() % drivers.size()], gate, 0);
+        drivers.push_back(gate);
+    }
+    connect(drivers[drivers.size() - 1], flipFlop, 0);
+    for (int i = 2; i <= 5; ++i) connect(drivers[drivers.size() - i], new Led(nullptr), 0);
+
+    Netlist netlist;
+    netlist.compile(objects);
+    CombinationalModel model;
+    check(model.compile(netlist), "building the model");
+
+    std::vector<Pattern> patterns(48, Pattern(model.inputs.size()));
+    for (auto& pattern : patterns) {
+        for (size_t i = 0; i < pattern.size(); ++i) pattern[i] = rng() & 1;
+    }
+
+    FaultSimulator simulator(model);
+    check(simulator.faults.size() > 2 * FaultSimulator::FAULTS_PER_PASS, "the faults take several passes");
+    std::vector<size_t> found;
+    for (const auto& pattern : patterns) found.push_back(simulator.simulate(pattern));
+
+    // The pattern that detects each fault first, without fault dropping
+    std::vector<size_t> expectedFound(patterns.size(), 0);
+    int wrong = 0, faultFree = 0;
+    size_t expectedDetected = 0;
+    for (size_t p = 0; p < patterns.size(); ++p) {
+        faultFree += serialEvaluate(model, patterns[p], nullptr) != model.evaluate(patterns[p]);
+    }
+    for (size_t f = 0; f < simulator.faults.size(); ++f) {
+        bool detected = false;
+        for (size_t p = 0; p < patterns.size() && !detected; ++p) {
+            detected = serialEvaluate(model, patterns[p], &simulator.faults[f]) != serialEvaluate(model, patterns[p], nullptr);
+            if (detected) expectedFound[p]++;
+        }
+        wrong += detected != simulator.detected[f];
+        expectedDetected += detected;
+    }
+    check(faultFree == 0, "the fault-free machine matches the model");
+    check(wrong == 0, "the detected faults match a serial simulation");
+    check(simulator.detectedCount() == expectedDetected, "the detected count");
+    check(found == expectedFound, "each pattern reports the faults it detected first");
+    check(expectedDetected > 0 && expectedDetected < simulator.faults.size(), "the patterns leave some faults undetected");
+
+    simulator.reset();
+    check(simulator.detectedCount() == 0 && simulator.simulate(patterns) == expectedDetected, "grading again after reset()");
+
+    while (!objects.empty()) delete objects.back();
+}
+
+int main() {
+    matchesSerial();
+    if (failures > 0) return 1;
+    SDL_Log("All fault simulator tests passed.");
+    return 0;
+}
@@ -0,0 +1,86 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+
+#include "Simulator.hpp"
+#include "Journal.hpp"
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what) {
+    if (condition) return;
+    SDL_LogError(SDL_LOG_CATEGORY_ERROR, "FAILED: %s", what);
+    failures++;
+}
+
+// Button -> Wire -> Led
+struct Chain {
+    Button* button = new Button(nullptr);
+    Wire* wire = new Wire(nullptr);
+    Led* led = new Led(nullptr);
+
+    Chain() {
+        Object::connect(button, wire);
+        Object::connect(wire, led);
+    }
+
+    bool consistent() const { return wire->state() == button->state() && led->state() == wire->state(); }
+};
+
+// A press is recorded like any other change, so rewinding past it releases the button again
+static void pressAndRewind() {
+    Journal journal;
+    changeListeners.push_back(&journal);
+    Chain chain;
+    propagate(1000);
+
+    chain.button->press();
+    propagate(1000);
+    check(chain.button->state() && chain.led->state(), "the press reaches the led");
+
+    while (journal.stepBack()) {}
+    check(!chain.button->state() && !chain.led->state(), "stepping back to the start releases the button");
+
+    chain.button->press();
+    propagate(1000);
+    chain.button->press();
+    propagate(1000);
+    check(journal.jumpTo(journal.earliestTime()), "jumping to the earliest time");
+    check(!chain.button->state() && chain.consistent(), "jumping back releases the button");
+    while (journal.stepForward()) {}
+    check(!chain.button->state() && chain.consistent(), "stepping forward replays both presses");
+
+    changeListeners.clear();
+}
+
+// Deleting an object moves another into its place in objects, and a new object takes over its slot.
+// Neither may change what the history or a name refers to.
+static void deletionKeepsIdentities() {
+    Gate* deleted = new Gate(nullptr, AND);
+    Chain chain;
+    const std::string name = objectName(deleted);
+    const Uint32 slot = deleted->handle.slot;
+    delete deleted;
+    Gate* successor = new Gate(nullptr, AND);
+    check(successor->handle.slot == slot && objectName(successor) != name, "a reused slot gets a new name");
+
+    Journal journal;
+    changeListeners.push_back(&journal);
+    propagate(1000);
+    chain.button->press();
+    propagate(1000);
+    while (journal.stepBack()) {}
+    check(!chain.button->state() && chain.consistent() && !successor->state(), "rewinding after a deletion");
+
+    changeListeners.clear();
+}
+
+int main() {
+    pressAndRewind();
+    deletionKeepsIdentities();
+    if (failures > 0) return 1;
+    SDL_Log("All journal tests passed.");
+    return 0;
+}
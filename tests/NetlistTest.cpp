@@ -0,0 +1,175 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <random>
+
+#include "Simulator.hpp"
+#include "Netlist.hpp"
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what) {
+    if (condition) return;
+    SDL_LogError(SDL_LOG_CATEGORY_ERROR, "FAILED: %s", what);
+    failures++;
+}
+
+static Wire* connect(Object* src, Object* dest, const int inputPin) {
+    auto* wire = new Wire(nullptr);
+    Object::connect(src, wire);
+    Object::connect(wire, dest, 0, inputPin);
+    return wire;
+}
+
+// Levels and every CSR row match a netlist compiled from scratch. Within a level the order depends on
+// the edits that led to it, so it only has to hold the same nodes, sorted by level.
+static bool matchesCompile(const Netlist& netlist) {
+    Netlist fresh;
+    fresh.compile(objects);
+    std::vector<Uint32> order = netlist.order;
+    for (size_t i = 1; i + fresh.cyclic < order.size(); ++i) {
+        if (netlist.level[order[i - 1]] > netlist.level[order[i]]) return false;
+    }
+    std::ranges::sort(order);
+    std::vector<Uint32> freshOrder = fresh.order;
+    std::ranges::sort(freshOrder);
+    return netlist.nodes == fresh.nodes && netlist.level == fresh.level && order == freshOrder &&
+           netlist.fanoutStart == fresh.fanoutStart && netlist.fanout == fresh.fanout &&
+           netlist.pinStart == fresh.pinStart && netlist.faninStart == fresh.faninStart &&
+           netlist.fanin == fresh.fanin && netlist.faninPin == fresh.faninPin &&
+           netlist.inputs == fresh.inputs && netlist.outputs == fresh.outputs &&
+           netlist.clocks == fresh.clocks && netlist.sequential == fresh.sequential &&
+           netlist.cyclic == fresh.cyclic;
+}
+
+// Replays orderRemoved and orderInserted on the previous order, as CycleSimulator does
+static bool patchesOrder(const std::vector<Object*>& previous, const Netlist& netlist) {
+    std::vector<Object*> kept;
+    for (size_t i = 0, removed = 0; i < previous.size(); ++i) {
+        if (removed < netlist.orderRemoved.size() && netlist.orderRemoved[removed] == i) removed++;
+        else kept.push_back(previous[i]);
+    }
+    std::vector<Object*> patched;
+    for (size_t i = 0, from = 0, inserted = 0; i < netlist.order.size(); ++i) {
+        if (inserted < netlist.orderInserted.size() && netlist.orderInserted[inserted] == i) {
+            patched.push_back(netlist.nodes[netlist.order[i]]);
+            inserted++;
+        } else if (from < kept.size()) {
+            patched.push_back(kept[from++]);
+        }
+    }
+    for (size_t i = 0; i < netlist.order.size(); ++i) {
+        if (patched[i] != netlist.nodes[netlist.order[i]]) return false;
+    }
+    return true;
+}
+
+static std::vector<Object*> orderOf(const Netlist& netlist) {
+    std::vector<Object*> order;
+    for (const Uint32 node : netlist.order) order.push_back(netlist.nodes[node]);
+    return order;
+}
+
+static void clearObjects() {
+    while (!objects.empty()) delete objects.back();
+}
+
+// Random edits that keep the gates acyclic: gates are only ever driven by gates created before them
+static void randomEdits() {
+    std::mt19937 rng(39);
+    std::vector<Object*> sources;
+    for (int i = 0; i < 8; ++i) sources.push_back(new Button(nullptr));
+    auto* clock = new Clock(nullptr);
+    std::vector<Object*> gates;
+    const auto pick = [&](std::vector<Object*>& from) -> Object* {
+        Object* obj = from[rng() % from.size()];
+        return obj ? obj : sources[rng() % sources.size()];
+    };
+    const auto addGate = [&] {
+        auto* gate = new Gate(nullptr, static_cast<GateType>(rng() % 8));
+        const int pins = static_cast<int>(gate->inputPins.size());
+        for (int pin = 0; pin < pins; ++pin) connect(gates.empty() || rng() % 4 == 0 ? pick(sources) : pick(gates), gate, pin);
+        gates.push_back(gate);
+    };
+    for (int i = 0; i < 200; ++i) addGate();
+    for (int i = 0; i < 8; ++i) {
+        auto* flipFlop = new FlipFlop(nullptr, DFF);
+        connect(pick(gates), flipFlop, 0);
+        connect(clock, flipFlop, 1);
+        sources.push_back(flipFlop);
+        connect(pick(gates), new Led(nullptr), 0);
+    }
+
+    Netlist netlist;
+    netlist.compile(objects);
+    int mismatches = 0, badPatches = 0, fallbacks = 0;
+    for (int edit = 0; edit < 300; ++edit) {
+        const std::vector<Object*> previous = orderOf(netlist);
+        switch (rng() % 4) {
+            case 0:
+                addGate();
+                break;
+            case 1: {
+                const size_t i = rng() % gates.size();
+                delete gates[i];
+                gates[i] = nullptr;
+                break;
+            }
+            case 2: {
+                const size_t from = rng() % gates.size(), to = from + 1 + rng() % 50;
+                if (to < gates.size() && gates[from] && gates[to]) connect(gates[from], gates[to], 0);
+                break;
+            }
+            default: {
+                Object* obj = objects[rng() % objects.size()];
+                if (obj->kind == KIND_WIRE && !obj->inputPins[0].empty()) obj->disconnect(obj->inputPins[0][0]);
+                break;
+            }
+        }
+        const bool incremental = netlist.update(objects);
+        fallbacks += !incremental;
+        mismatches += !matchesCompile(netlist);
+        badPatches += incremental && !patchesOrder(previous, netlist);
+    }
+    check(mismatches == 0, "update() matches a fresh compile after random edits");
+    check(badPatches == 0, "orderRemoved and orderInserted turn the old order into the new one");
+    check(fallbacks == 0, "edits without loops are applied incrementally");
+    clearObjects();
+}
+
+// Closing a loop falls back to a full compile, and so does opening it again
+static void loopFallback() {
+    auto* button = new Button(nullptr);
+    auto* first = new Gate(nullptr, OR);
+    auto* second = new Gate(nullptr, NOT);
+    connect(button, first, 0);
+    connect(first, second, 0);
+    connect(second, new Led(nullptr), 0);
+
+    Netlist netlist;
+    netlist.compile(objects);
+    check(netlist.cyclic == 0, "a chain has no loop");
+
+    Wire* back = connect(second, first, 1);
+    check(!netlist.update(objects), "closing a loop compiles from scratch");
+    check(netlist.cyclic > 0 && matchesCompile(netlist), "the loop is found as by compile()");
+
+    delete back;
+    netlist.update(objects);
+    check(netlist.cyclic == 0 && matchesCompile(netlist), "opening the loop again");
+
+    connect(button, new Gate(nullptr, BUF), 0);
+    check(netlist.update(objects) && matchesCompile(netlist), "updates are incremental again afterwards");
+    clearObjects();
+}
+
+int main() {
+    randomEdits();
+    loopFallback();
+    if (failures > 0) return 1;
+    SDL_Log("All netlist tests passed.");
+    return 0;
+}
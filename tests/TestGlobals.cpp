@@ -0,0 +1,35 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <deque>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#include "Simulator.hpp"
+#include "TextureCache.hpp"
+#include "SpriteBatch.hpp"
+#include "LineBatch.hpp"
+#include "Camera.hpp"
+#include "CycleSimulator.hpp"
+
+// The globals main.cpp defines for the application
+std::vector<Object*> objects;
+std::vector<Object*> selectedObjects;
+std::vector<Object*> objectsOfKind[KIND_COUNT];
+std::queue<ObjectHandle> eventQueue;
+ObjectSlots objectSlots;
+SimulationData simulationData;
+SpatialIndex spatialIndex;
+Camera camera;
+std::vector<Object*> sequentialQueue;
+Uint64 netlistVersion = 0;
+Uint64 simTime = 0;
+size_t deltaRemaining = 0;
+std::vector<ChangeListener*> changeListeners;
+std::deque<ObjectView> objectViews;
+
+TextureCache textureCache;
+SpriteBatch spriteBatch;
+LineBatch lineBatch;
+CycleSimulator cycleSimulator;
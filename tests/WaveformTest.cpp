@@ -0,0 +1,120 @@
+//
+// Created by konstantinos on 10/19/26.
+//
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "Simulator.hpp"
+#include "Waveform.hpp"
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what) {
+    if (condition) return;
+    SDL_LogError(SDL_LOG_CATEGORY_ERROR, "FAILED: %s", what);
+    failures++;
+}
+
+static constexpr const char* PATH = "WaveformTest.lswf";
+
+// Value of a signal at a time, from the changes that were recorded
+static bool expectedAt(const std::vector<WaveformChange>& changes, const bool initial, const Uint64 time) {
+    bool value = initial;
+    for (const auto& change : changes) {
+        if (change.time > time) break;
+        value = change.value;
+    }
+    return value;
+}
+
+static bool sameChanges(const std::vector<WaveformChange>& a, const std::vector<WaveformChange>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].time != b[i].time || a[i].value != b[i].value) return false;
+    }
+    return true;
+}
+
+// A fast signal spanning several blocks, a slow one within a single block, and one that never
+// changes, written through the writer and read back from the mapped file
+static void roundTrip() {
+    auto* fast = new Button(nullptr);
+    auto* slow = new Button(nullptr);
+    auto* idle = new Button(nullptr);
+    slow->press();
+    const Uint64 start = simTime;
+
+    WaveformWriter writer;
+    check(writer.open(PATH, {fast, slow, idle}), "creating the waveform file");
+    changeListeners.push_back(&writer);
+
+    std::vector<WaveformChange> fastChanges, slowChanges;
+    const size_t fastCount = 2 * WaveformWriter::BLOCK_CHANGES + 100;
+    for (size_t i = 0; i < fastCount; ++i) {
+        // Uneven gaps, so the deltas take one and two byte varints
+        const Uint64 gap = i % 7 == 0 ? 200 : 1 + i % 3;
+        for (Uint64 k = 0; k < gap; ++k) advanceTime();
+        fast->press();
+        fastChanges.push_back({simTime, fast->state()});
+        if (i % 1000 == 0) {
+            slow->press();
+            slowChanges.push_back({simTime, slow->state()});
+        }
+    }
+    const Uint64 end = simTime;
+    changeListeners.clear();
+    writer.close();
+
+    WaveformReader reader;
+    check(reader.open(PATH), "opening the waveform file");
+    check(reader.signalCount() == 3 && reader.startTime() == start, "the header");
+    check(reader.findSignal(objectName(slow)) == 1 && reader.findSignal("missing") == -1, "finding signals by name");
+
+    check(sameChanges(reader.read(0, 0, end), fastChanges), "reading back every change of a signal over several blocks");
+    check(sameChanges(reader.read(1, 0, end), slowChanges), "reading back a signal within one block");
+    check(reader.read(2, 0, end).empty(), "a signal that never changed has no changes");
+
+    // A window straddling the boundary between the first two blocks of the fast signal
+    const Uint64 boundary = fastChanges[WaveformWriter::BLOCK_CHANGES].time;
+    std::vector<WaveformChange> window;
+    for (const auto& change : fastChanges) {
+        if (change.time >= boundary - 50 && change.time <= boundary + 50) window.push_back(change);
+    }
+    check(sameChanges(reader.read(0, boundary - 50, boundary + 50), window), "reading across a block boundary");
+
+    int wrong = 0;
+    for (Uint64 time = start; time <= end; time += 7) {
+        wrong += reader.valueAt(0, time) != expectedAt(fastChanges, false, time);
+        wrong += reader.valueAt(1, time) != expectedAt(slowChanges, true, time);
+        wrong += reader.valueAt(2, time);
+    }
+    // Exactly at, and right around, the first and last change of each block
+    for (const size_t i : {size_t{0}, WaveformWriter::BLOCK_CHANGES - 1, WaveformWriter::BLOCK_CHANGES,
+                           2 * WaveformWriter::BLOCK_CHANGES, fastCount - 1}) {
+        for (const Uint64 time : {fastChanges[i].time - 1, fastChanges[i].time, fastChanges[i].time + 1}) {
+            wrong += reader.valueAt(0, time) != expectedAt(fastChanges, false, time);
+        }
+    }
+    check(wrong == 0, "valueAt() matches the recorded changes");
+    check(!reader.valueAt(0, start) && reader.valueAt(1, start), "values before the first change are the initial ones");
+    reader.close();
+
+    // A file cut short loses its footer, and must be refused rather than read past its end
+    size_t size = 0;
+    void* data = SDL_LoadFile(PATH, &size);
+    check(data && SDL_SaveFile(PATH, data, size / 2) && !reader.open(PATH), "refusing a truncated file");
+    SDL_free(data);
+    SDL_RemovePath(PATH);
+
+    delete fast;
+    delete slow;
+    delete idle;
+}
+
+int main() {
+    roundTrip();
+    if (failures > 0) return 1;
+    SDL_Log("All waveform tests passed.");
+    return 0;
+}